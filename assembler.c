@@ -8,38 +8,282 @@
 
 struct machine_t
 {
-    int data_array[MAX_DATA]; /* the data array of the machine to store the labels data values */
-    int DC:8; /* the number of data values inside the machine data array (can be maximum 256) */
+    int *data_array; /* the data array of the machine to store the labels data values */
+    int DC; /* the number of data values inside the machine data array (can be maximum MAX_DATA) */
+    int data_size; /* the number of data values the data array can contain */
     int IC; /* the number of machine words inside the instructions (starts at base 100)*/
     unsigned has_mcr:1; /* a flag that informs if an instruction had been declared for the pre assembler */
     unsigned has_label:1; /* a flag that informs if a label had been declared in the start of the command */
     unsigned initiated_labels:1; /* after the first scan set to true */
     unsigned write_entry_file:1; /* tells the machine if to create an entry file */
     unsigned write_extern_file:1; /* tells the machine if to create an extern file */
+    unsigned externs_by_address:1; /* tells the machine to write the extern file by the word numbers instead of grouping it by the labels */
+    unsigned is_chunk:1; /* a flag that informs if the machine scans only a chunk of a file, then a data overflow is recorded instead of exiting */
+    unsigned data_overflow:1; /* a flag that informs if a chunk machine had more data than MAX_DATA */
+    unsigned keep_unchanged_outputs:1; /* tells the machine to write only the output files that their text changed */
+    unsigned write_symbol_file:1; /* tells the machine to write the symbol file of every label with the other output files */
+    unsigned write_references_file:1; /* tells the machine to keep the uses of the labels and write the cross-reference file with the other output files */
+    unsigned write_listing_file:1; /* tells the machine to write the listing file of the source lines and their words with the other output files */
+    int *failed_lines; /* the numbers of the lines that had errors in the first scan, in ascending order */
+    int failed_count; /* the number of lines inside the failed lines array */
+    int failed_size; /* the number of lines the failed lines array can contain */
     label_table *labels_table; /* the label table of the current machine */
     instruction_list *instructions_list; /* the instruction list of the current machine */
+    instruction_listener instruction_listener; /* called in the second scan for every instruction that its operands are final, can be NULL */
+    void *listener_context; /* the context that the instruction listener receives */
+    diagnostics *diagnostics; /* the errors of the current file, kept until they are flushed */
+    macro_table *prelude; /* the read-only macros that every file can use, not freed by the machine, can be NULL */
+    include_cache *include_cache; /* the files that were included during the run, not freed by the machine, can be NULL */
+    instructions_encoder instructions_encoder; /* converts the instructions into the object file lines */
+    void *encoder_context; /* the context that the instructions encoder receives */
 };
 
 int full_assembler(machine *machine, char *file_name) {
-    if(pre_assembler(file_name) != false)
-        return false;
-    if(assembler_first_scan(machine, file_name) != false)
+    int error = pre_assembler(file_name, machine->diagnostics, machine->prelude, machine->include_cache);
+    if(error == PRE_ASSEMBLER_NO_FILE)
         return false;
+    if(assembler_first_scan(machine, file_name) != false) /* the second scan skips the lines that failed, so its errors are printed too */
+        error = true;
     if(assembler_second_scan(machine, file_name) != false)
+        error = true;
+    if(error != false)
         return false;
     return convert_to_machine_code(machine, file_name);
 }
 
+/**
+ * Does a given scan on the lines of a given expanded text of a file, its errors are added with the name of the .am file of the file.
+ * @param machine the current machine to use.
+ * @param file_name a given file name without extension.
+ * @param text the expanded lines of the file.
+ * @param length the number of characters of the text.
+ * @param scan the scan to do: assembler_first_scan_lines or assembler_second_scan_lines.
+ * @returns false if the lines does not have errors, retrns true otherwise
+*/
+int scan_expanded_text(machine *machine, char *file_name, char *text, size_t length, lines_scan scan) {
+    text_reader lines;
+    line_reader *reader;
+    error_location *error_info = create_empty_error_location(get_file_full_name(file_name, ".am")); /* the errors keep the locations of a full assembly */
+    int error;
+    lines.text = text;
+    lines.length = length;
+    lines.position = 0;
+    reader = create_block_line_reader(read_text_block, &lines);
+    error_location_set_diagnostics(error_info, machine->diagnostics);
+    error = scan(machine, reader, error_info);
+    free_line_reader(reader);
+    free_error_location(error_info);
+    return error;
+}
+
+int syntax_only_assembler(machine *machine, char *file_name) {
+    output_buffer *writer = create_memory_output_buffer(); /* the expanded lines are kept in memory instead of the .am file */
+    FILE *input = open_file(file_name, ".as", "r");
+    char *text;
+    size_t length;
+    int error;
+    if(input == NULL) {
+        free_output_buffer(writer);
+        return false;
+    }
+    error = pre_assembler_expand(file_name, input, writer, machine->diagnostics, machine->prelude, machine->include_cache);
+    fclose(input);
+    text = output_buffer_get_text(writer);
+    length = output_buffer_get_length(writer);
+    if(scan_expanded_text(machine, file_name, text, length, assembler_first_scan_lines) != false) /* every step runs so all the errors are found, as full_assembler does */
+        error = true;
+    if(scan_expanded_text(machine, file_name, text, length, assembler_second_scan_lines) != false)
+        error = true;
+    free_output_buffer(writer);
+    return error == false;
+}
+
 machine *initialize_machine() {
     machine *main_machine = (machine*) malloc_and_check(sizeof(machine));
     main_machine->labels_table = NULL;
     main_machine->instructions_list = NULL;
+    main_machine->failed_size = FAILED_LINES_START_SIZE;
+    main_machine->failed_lines = (int*) malloc_and_check(sizeof(int) * main_machine->failed_size);
+    main_machine->data_size = DATA_START_SIZE;
+    main_machine->data_array = (int*) malloc_and_check(sizeof(int) * main_machine->data_size);
+    main_machine->diagnostics = create_diagnostics(DIAGNOSTICS_TEXT, DIAGNOSTICS_UNLIMITED);
+    main_machine->prelude = NULL;
+    main_machine->include_cache = NULL;
+    main_machine->instruction_listener = NULL;
+    main_machine->listener_context = NULL;
+    main_machine->instructions_encoder = encode_instructions;
+    main_machine->encoder_context = NULL;
+    main_machine->is_chunk = false;
+    main_machine->externs_by_address = false;
+    main_machine->keep_unchanged_outputs = false;
+    main_machine->write_symbol_file = false;
+    main_machine->write_references_file = false;
+    main_machine->write_listing_file = false;
     reset_machine(main_machine);
     return main_machine;
 }
 
-void reset_machine(machine *machine) {
+void machine_set_instructions_encoder(machine *machine, instructions_encoder encoder, void *context) {
+    if(machine == NULL)
+        return;
+    machine->instructions_encoder = encoder != NULL ? encoder : encode_instructions;
+    machine->encoder_context = encoder != NULL ? context : NULL;
+}
+
+void machine_set_externs_order(machine *machine, int sorted_by_address) {
+    if(machine != NULL)
+        machine->externs_by_address = sorted_by_address;
+}
+
+void machine_set_diagnostics_format(machine *machine, DIAGNOSTICS_FORMAT format, int max_errors) {
+    if(machine == NULL)
+        return;
+    free_diagnostics(machine->diagnostics);
+    machine->diagnostics = create_diagnostics(format, max_errors);
+}
+
+diagnostics *machine_get_diagnostics(machine *machine) {
+    return machine != NULL ? machine->diagnostics : NULL;
+}
+
+void machine_set_prelude(machine *machine, macro_table *prelude) {
+    if(machine != NULL)
+        machine->prelude = prelude;
+}
+
+macro_table *machine_get_prelude(machine *machine) {
+    return machine != NULL ? machine->prelude : NULL;
+}
+
+void machine_set_include_cache(machine *machine, include_cache *cache) {
+    if(machine != NULL)
+        machine->include_cache = cache;
+}
+
+include_cache *machine_get_include_cache(machine *machine) {
+    return machine != NULL ? machine->include_cache : NULL;
+}
+
+void machine_set_keep_unchanged_outputs(machine *machine, int status) {
+    if(machine != NULL)
+        machine->keep_unchanged_outputs = status;
+}
+
+void machine_set_symbol_file(machine *machine, int status) {
+    if(machine != NULL)
+        machine->write_symbol_file = status;
+}
+
+void machine_set_references_file(machine *machine, int status) {
+    if(machine != NULL)
+        machine->write_references_file = status;
+}
+
+void machine_set_listing_file(machine *machine, int status) {
+    if(machine != NULL)
+        machine->write_listing_file = status;
+}
+
+void machine_set_chunk_status(machine *machine, int status) {
+    if(machine != NULL)
+        machine->is_chunk = status;
+}
+
+/**
+ * Makes room in the data array of a given machine for a given number of data values after its DC, the array is doubled until they fit.
+ * @param machine a given machine.
+ * @param count the number of data values to add.
+*/
+void machine_reserve_data(machine *machine, int count) {
+    if(machine->DC + count <= machine->data_size)
+        return;
+    while(machine->DC + count > machine->data_size)
+        machine->data_size *= 2;
+    machine->data_array = (int*) realloc_and_check(machine->data_array, sizeof(int) * machine->data_size);
+}
+
+int machine_merge_chunk(machine *main_machine, machine *chunk, int keep_chunk) {
+    label_table *labels;
+    int lbl, first_id, i;
+    if(main_machine == NULL || chunk == NULL)
+        return false;
+    if(chunk->data_overflow != false || main_machine->DC + chunk->DC > MAX_DATA)
+        return false;
+    labels = chunk->labels_table;
+    for(lbl = 0; lbl < label_table_get_count(labels); lbl++) /* every label name must be unique over all the chunks */
+        if(search_in_label_table(main_machine->labels_table, label_get_name(labels, lbl)) != LABEL_NONE)
+            return false;
+    labels = main_machine->labels_table;
+    first_id = label_table_get_count(labels);
+    if(keep_chunk != false) /* the labels are rebased after they are added, so a kept chunk keeps its values */
+        label_table_append_copy(labels, chunk->labels_table);
+    else
+        label_table_append(labels, chunk->labels_table);
+    for(lbl = first_id; lbl < label_table_get_count(labels); lbl++) { /* the chunk counters started from the start of the file */
+        if(label_get_type(labels, lbl) == LABEL_CODE)
+            label_set_IC(labels, lbl, label_get_IC(labels, lbl) + main_machine->IC - IC_START);
+        else if(label_get_type(labels, lbl) == LABEL_DATA || label_get_type(labels, lbl) == LABEL_STRING)
+            label_set_IC(labels, lbl, label_get_IC(labels, lbl) + main_machine->DC);
+    }
+    machine_reserve_data(main_machine, chunk->DC);
+    for(i = 0; i < chunk->DC; i++)
+        main_machine->data_array[main_machine->DC + i] = chunk->data_array[i];
+    main_machine->DC += chunk->DC;
+    main_machine->IC += chunk->IC - IC_START;
+    if(keep_chunk != false)
+        instruction_list_append_copy(main_machine->instructions_list, chunk->instructions_list);
+    else
+        instruction_list_append(main_machine->instructions_list, chunk->instructions_list);
+    for(i = 0; i < chunk->failed_count; i++) /* the chunk lines numbers are already the lines numbers of the whole file */
+        machine_add_failed_line(main_machine, chunk->failed_lines[i]);
+    return true;
+}
+
+void machine_shift_lines(machine *chunk, int delta) {
+    instruction *instruct;
     int i;
+    if(chunk == NULL || delta == 0)
+        return;
+    for(instruct = get_first_intruction(chunk->instructions_list); instruct != NULL; instruct = get_next_instruction(instruct))
+        instruction_set_line(instruct, instruction_get_line(instruct) + delta);
+    for(i = 0; i < chunk->failed_count; i++)
+        chunk->failed_lines[i] += delta;
+    label_table_shift_lines(chunk->labels_table, delta);
+}
+
+void machine_add_failed_line(machine *machine, int line) {
+    if(machine == NULL)
+        return;
+    if(machine->failed_count >= machine->failed_size) {
+        machine->failed_size *= 2;
+        machine->failed_lines = (int*) realloc_and_check(machine->failed_lines, sizeof(int) * machine->failed_size);
+    }
+    machine->failed_lines[machine->failed_count++] = line;
+}
+
+int machine_get_address_width(machine *machine) {
+    return get_address_width(machine->IC + machine->DC - 1);
+}
+
+void free_machine(machine *machine) {
+    if(machine == NULL)
+        return;
+    free_label_table(machine->labels_table);
+    free_instruction_list(machine->instructions_list);
+    free(machine->failed_lines);
+    free(machine->data_array);
+    free_diagnostics(machine->diagnostics);
+    free(machine);
+}
+
+void machine_set_instruction_listener(machine *machine, instruction_listener listener, void *context) {
+    if(machine == NULL)
+        return;
+    machine->instruction_listener = listener;
+    machine->listener_context = context;
+}
+
+void reset_machine(machine *machine) {
     if(machine == NULL)
         return;
     machine->DC = 0;
@@ -49,12 +293,12 @@ void reset_machine(machine *machine) {
     machine->initiated_labels = false;
     machine->write_entry_file = false;
     machine->write_extern_file = false;
+    machine->data_overflow = false;
+    machine->failed_count = 0;
     free_label_table(machine->labels_table);
     machine->labels_table = create_empty_label_table();
     free_instruction_list(machine->instructions_list);
     machine->instructions_list = create_empty_instruction_list();
-    for(i = 0; i < MAX_DATA; i++)
-        machine->data_array[i] = 0;
 }
 
 int process_addressing_parameter(char *str, machine *machine, COMMAND_TYPE *command_type, instruction *instruct, char c, int comma_count, error_location *error_info) {
@@ -84,10 +328,14 @@ void process_operand(char str[], machine *machine, instruction *instruct, COMMAN
     OPCODE_TYPE opcode_type = instruction_get_opcode_type(instruct);
     ADDRESSING_MODE addressing_type = ADRESSING_UNKOWN; /* used for checking the dressing type of str */
     int num;
-    label *lbl = NULL; /* the label to contain the name str, if str is legal and exists */
-    LABEL_TYPE label_type; /* the label type of lbl (if lbl does not equals to NULL) */
+    int lbl = LABEL_NONE; /* the id of the label to contain the name str, if str is legal and exists */
+    LABEL_TYPE label_type; /* the label type of lbl (if lbl does not equals to LABEL_NONE) */
     if(str[0] == '#') { /* if the first character is '#' then the following string must be an integer*/
-        if(is_integer(&str[1])) { /* if the followaing string is not an integer then an error occurs */
+        if(is_integer(&str[1]) && is_integer_in_range(&str[1], INT_MIN_VALUE, INT_MAX_VALUE) == false) { /* the integer must fit in the bits of an operand word */
+            print_error_location(error_info, "the integer %s can't be stored in an operand word, an immediate integer must be between %i and %i", &str[1], INT_MIN_VALUE, INT_MAX_VALUE);
+            *command_type = ERROR;
+        }
+        else if(is_integer(&str[1])) { /* if the followaing string is not an integer then an error occurs */
             addressing_type = ADDRESSING_IMMEDIATE;
             if(*command_type == COMMAND_SOURCE_OPERAND) {
                 if(opcode_type == LEA) { /* the addressing type of the source operand of the opcode lea can't be an immediate addressing */
@@ -156,38 +404,43 @@ void process_operand(char str[], machine *machine, instruction *instruct, COMMAN
                 /* we use machine->initiated_labels because in the first scan the label table had not been fully initiated therefore we only check the validity of str instaed of the existence of str in the label table */
                 if(machine->initiated_labels != false)
                     lbl = search_in_label_table(machine->labels_table, str);
-                if(lbl != NULL || machine->initiated_labels == false) {
-                    label_type = label_get_type(lbl);
-                    if(*command_type == COMMAND_SOURCE_OPERAND) {
+                if(lbl != LABEL_NONE || machine->initiated_labels == false) {
+                    label_type = label_get_type(machine->labels_table, lbl);
+                    if(lbl != LABEL_NONE && label_get_IC(machine->labels_table, lbl) > LABEL_MAX_ADDRESS) { /* the address must fit in the bits of an operand word */
+                        print_error_location(error_info, "the address %i of the label \"%s\" can't be stored in an operand word, a label address must be at most %i", 
+                            label_get_IC(machine->labels_table, lbl), str, LABEL_MAX_ADDRESS);
+                        *command_type = ERROR;
+                    }
+                    else if(*command_type == COMMAND_SOURCE_OPERAND) {
                         instruction_set_input_addressing(instruct, ADDRESSING_DIRECT);
                         *command_type = COMMAND_DEST_OPERAND;
-                        if(lbl != NULL) { /* we check this only in the second scan and not in the first scan */
+                        if(lbl != LABEL_NONE) { /* we check this only in the second scan and not in the first scan */
                             if(label_type == LABEL_CODE) { /* labels that are pointing to code can't be used as a source operand */
                                 print_error_location(error_info, "opcode labels are not allowed to be used as a source operand in the opcode %s", get_opcode_name(opcode_type));
                                 *command_type = ERROR;
                             }
                             else {
                                 if(label_type == LABEL_EXTERN) { /*if the label type is extern then add the current IC to the label extern list */
-                                    label_add_extern_word_index(lbl, machine->IC);
+                                    label_table_add_extern_use(machine->labels_table, lbl, machine->IC);
                                     machine->write_extern_file = true;
                                 }
-                                instruction_set_input_operand(instruct, label_get_IC(lbl));
+                                instruction_set_input_operand(instruct, label_get_IC(machine->labels_table, lbl));
                             }
                         }
                     }
                     else if(*command_type == COMMAND_JUMP_OPERAND) {
                         *command_type = EXECUTE; /* we check in function "process_addressing_parameter" if the char '(' is detected and then we address parameters */
-                        if(lbl != NULL) { /* we check this only in the second scan and not in the first scan */
+                        if(lbl != LABEL_NONE) { /* we check this only in the second scan and not in the first scan */
                             if(label_type != LABEL_CODE && label_type != LABEL_EXTERN) { /* only labels that are pointing to code/extern are allowed as the destination operand for the opcodes: jmp, bne and jsr*/
                                 print_error_location(error_info, "direct addressing is not allowed to be used as a destination operand in the opcode %s", get_opcode_name(opcode_type));
                                 *command_type = ERROR;
                             }
                             else {                              
                                 if(label_type == LABEL_EXTERN) { /*if the label type is extern then add the current IC to the label extern list */
-                                    label_add_extern_word_index(lbl, machine->IC);
+                                    label_table_add_extern_use(machine->labels_table, lbl, machine->IC);
                                     machine->write_extern_file = true;
                                 }
-                                instruction_set_addressing_parameter_operand(instruct, label_get_IC(lbl));
+                                instruction_set_addressing_parameter_operand(instruct, label_get_IC(machine->labels_table, lbl));
                             }
                         }
                     }
@@ -196,17 +449,17 @@ void process_operand(char str[], machine *machine, instruction *instruct, COMMAN
                         *command_type = EXECUTE;
                         if(instruction_get_input_addressing(instruct) == ADDRESSING_REGISTER) /* if the second or third word is a register then the current label will be added into a new word */
                             machine->IC++;
-                        if(lbl != NULL) { /* we check this only in the second scan and not in the first scan */
+                        if(lbl != LABEL_NONE) { /* we check this only in the second scan and not in the first scan */
                             if(label_type == LABEL_CODE) { /* labels that are pointing to code can't be used as a destination operand or as a second parameter */
                                 print_error_location(error_info, "opcode labels are not allowed to be used as a destination operand in the opcode %s", get_opcode_name(opcode_type));
                                 *command_type = ERROR;
                             }
                             else {
                                 if(label_type == LABEL_EXTERN) { /*if the label type is extern then add the current IC to the label extern list */
-                                    label_add_extern_word_index(lbl, machine->IC);          
+                                    label_table_add_extern_use(machine->labels_table, lbl, machine->IC);          
                                     machine->write_extern_file = true;
                                 }
-                                instruction_set_output_operand(instruct, label_get_IC(lbl));
+                                instruction_set_output_operand(instruct, label_get_IC(machine->labels_table, lbl));
                             }
                         }
                     }                                        
@@ -220,11 +473,36 @@ void process_operand(char str[], machine *machine, instruction *instruct, COMMAN
                 *command_type = ERROR;
         }
     }
+    if(*command_type != ERROR && lbl != LABEL_NONE && machine->write_references_file != false) /* the IC is the word of the label operand, as the extern uses above */
+        label_table_add_use(machine->labels_table, lbl, error_location_get_line(error_info), machine->IC);
     if(*command_type != ERROR && addressing_type != ADDRESSING_REGISTER) /* if the current addressing type is not addressing register then current word will be added into the machine word count, becuase we checked the registers above */
         machine->IC++;
 }
 
 int assembler_first_scan(machine *machine, char input_path[]) {
+    int error;
+    line_reader *reader;
+    error_location *error_info; /* the error location to print when an error occurs */
+    FILE *file = open_file(input_path, ".am", "r"); /* read file */
+    if(file == NULL)
+        return true;
+    error_info = create_empty_error_location(get_file_full_name(input_path, ".am"));
+    error_location_set_diagnostics(error_info, machine->diagnostics);
+    reader = create_line_reader(file);
+    error = assembler_first_scan_lines(machine, reader, error_info);
+    free_line_reader(reader);
+    fclose(file); /* closes the file to insure safety */
+    free_error_location(error_info);
+    return error;
+}
+
+int assembler_first_scan_lines(machine *machine, line_reader *reader, error_location *error_info) {
+    int error = assembler_first_scan_commands(machine, reader, error_info);
+    assembler_first_scan_finish(machine); /* the labels are initiated even if the file has errors, so the second scan can check the other lines */
+    return error;
+}
+
+int assembler_first_scan_commands(machine *machine, line_reader *reader, error_location *error_info) {
     char command[MAX_COMMAND_LEN];
     char c;
     int error = false;
@@ -233,27 +511,25 @@ int assembler_first_scan(machine *machine, char input_path[]) {
     LABEL_TYPE label_type;
     char str[MAX_COMMAND_LEN];
     int length = 0;
-    label *lbl; /* the current label */
+    int lbl; /* the id of the current label */
     instruction *instruct; /* the current instruction */
-    int i, last_c = 0;
+    int i = 0, last_c = 0;
+    int end; /* the end of a data statement that was added at once */
     int whitespace_count = 0, comma_count = 0; /* the commas and whitespace count between 2 non null, whitespace and comma character*/
     int entered_string = false; /* when entering s a string that is used for when the command type is COMMAND_LABEL_VALUE and the label type is LABEL_STRING */
-    error_location *error_info; /* the error location to print when an error occurs */
-    FILE *file = open_file(input_path, ".am", "r"); /* read file */
-    if(file == NULL)
-        return true;
-    error_info = create_empty_error_location(get_file_full_name(input_path, ".am"));
+    char message[ERROR_MESSAGE_SIZE]; /* the missing operands error message */
     machine->DC = 0; /*reset the data and words counters */
     machine->IC = IC_START;
-    while((fgets(command, MAX_COMMAND_LEN, file)) != NULL) { /* read the file line by line */
+    error_location_track_index(error_info, &i); /* the index is read only when an error is printed */
+    while(error_location_limit_reached(error_info) == false && (line_reader_gets(reader, command, MAX_COMMAND_LEN)) != NULL) { /* read the file line by line until the maximum number of errors */
         error_location_ascend_line(error_info);
-        error_location_set_index(error_info, 0);
+        i = 0;
         command_type = COMMAND_LABEL_NAME;
         opcode_type = OPCODE_UNKOWN;
         label_type = LABEL_UNKOWN;
         length = 0;
         str[0] = '\0';
-        lbl = NULL;
+        lbl = LABEL_NONE;
         instruct = NULL;
         entered_string = false;
         comma_count = 0;
@@ -263,24 +539,16 @@ int assembler_first_scan(machine *machine, char input_path[]) {
         machine->has_label = false;
         if(command[0] != ';') { /* comment lines are ignored */
             for(i = 0; i < MAX_COMMAND_LEN; i++) {
-                error_location_set_index(error_info, i);
                 c = command[i];
                 if(command_type == EXECUTE) { /* if the command has no errors an can be exected check if there are more arguments than allowed errors */
                     if(is_end_null(c) == false && is_whitespace(c) == false) { /* if a non whitespace and non end nll character is arrived then an error occurs */
                         if(c == ',') { /* commas are illegal at the end of a command */
                             print_error_location(error_info, "Illegal comma");
                         }
-                        else if(opcode_type != OPCODE_UNKOWN) { /* if the command is an instruction then print the error message based on the opcode maximum arguments allowed */
-                            print_error_location(error_info, "The opcode \"%s\" ", get_opcode_name(opcode_type));
-                            if(is_opcode_group_three(opcode_type)) {
-                                print_error_location(error_info, "can't receive operands");
-                            }
-                            else if(is_opcode_group_two(opcode_type)) {
-                                print_error_location(error_info, "can't receive an input operand");
-                            }
-                            else
-                                print_error_location(error_info, "can't receive more than 2 operands");
-                        }
+                        else if(opcode_type != OPCODE_UNKOWN) /* if the command is an instruction then print the error message based on the opcode maximum arguments allowed */
+                            print_error_location(error_info, "The opcode \"%s\" %s", get_opcode_name(opcode_type), 
+                                is_opcode_group_three(opcode_type) ? "can't receive operands" : 
+                                is_opcode_group_two(opcode_type) ? "can't receive an input operand" : "can't receive more than 2 operands");
                         else /* if the command is not an instruction then additional characters not (whitespace,end null) are not allowed */
                             print_error_location(error_info, "Extraneous text after end of command");
                         command_type = ERROR;
@@ -289,19 +557,26 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                 else if(command_type == COMMAND_LABEL_VALUE && label_type == LABEL_STRING) { /* if a label type LABEL_STRING was declared then search for the string */
                     if(entered_string == true) { /* if the char " had been found */
                         if(c == '\"') { /* if the char is " then insert to the data array '\0' and set command type to be EXECUTE */
-                            add_new_data(machine, '\0', error_info);
-                            label_ascend_DC(lbl);
-                            command_type = EXECUTE;
+                            if(add_new_data(machine, '\0', error_info) != false) {
+                                label_ascend_DC(machine->labels_table, lbl);
+                                command_type = EXECUTE;
+                            }
+                            else
+                                command_type = ERROR;
                         }
                         else {
                             if(is_end_null(c) == false) { /* if the char is not an end null then add it to the data array */
-                                add_new_data(machine, c, error_info);
-                                last_c = i;
-                                label_ascend_DC(lbl);
+                                if(add_new_data(machine, c, error_info) != false) {
+                                    last_c = i;
+                                    label_ascend_DC(machine->labels_table, lbl);
+                                }
+                                else
+                                    command_type = ERROR;
                             }
                             else { /* the string was not closed therefore an error occurs */
-                                error_location_set_index(error_info, last_c);
+                                error_location_track_index(error_info, &last_c); /* the error is at the last character of the string */
                                 print_error_location(error_info, "missing \" declaration after '%c' token", command[last_c]);
+                                error_location_track_index(error_info, &i);
                                 command_type = ERROR;
                             }
                         }
@@ -316,6 +591,7 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                     }
                 }
                 else {
+                    int in_word = false; /* true\1 if the character was added to the current argument */
                     if(is_whitespace(c) == false && is_end_null(c) == false && c != ',') {
                         if(process_addressing_parameter(str, machine, &command_type, instruct, c, comma_count, error_info) != false) { /* we check if the command type changed, and if so then reset str */
                             str[0] = '\0';
@@ -324,6 +600,7 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                         else {
                             str[length++] = c;
                             str[length] = '\0';
+                            in_word = true;
                         }              
                     }
                     else if(length > 0) { /* empty arguments are ignored */
@@ -334,10 +611,11 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                                 if(is_label_legal_format(str, error_info)) { /* if str is not a legal format then an error occurs */
                                     if(label_type != LABEL_ENTRY) {
                                         lbl = search_in_label_table(machine->labels_table, str);
-                                        if(lbl == NULL) { /* if the label exists in the label table then an error occurs */
-                                            lbl = add_to_label_table(machine->labels_table, strdup(str));
+                                        if(lbl == LABEL_NONE) { /* if the label exists in the label table then an error occurs */
+                                            lbl = add_to_label_table(machine->labels_table, str);
+                                            label_set_line(machine->labels_table, lbl, error_location_get_line(error_info));
                                             if(label_type == LABEL_EXTERN) { /* LABEL_EXETRN next command type is EXECUTE */
-                                                label_set_type(lbl, LABEL_EXTERN);
+                                                label_set_type(machine->labels_table, lbl, LABEL_EXTERN);
                                                 command_type = EXECUTE;
                                             }
                                             machine->has_label = true; /* we set the flag has_label to true */
@@ -359,9 +637,14 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                                     if(label_type != LABEL_UNKOWN) { /* if the argment is a valid label type */
                                         if(label_type == LABEL_DATA || label_type == LABEL_STRING) {
                                             if(machine->has_label) { /* a label name declaration must be before the usage of the 2 following label types */
-                                                label_set_type(lbl, label_type);
-                                                label_set_IC(lbl, machine->DC);
+                                                label_set_type(machine->labels_table, lbl, label_type);
+                                                label_set_IC(machine->labels_table, lbl, machine->DC);
                                                 command_type = COMMAND_LABEL_VALUE;                                                
+                                                end = label_type == LABEL_DATA ? add_data_values(machine, command, i, lbl) : add_string_value(machine, command, i, lbl);
+                                                if(end >= 0) { /* the whole statement was added at once, the scan continues from the end of the line */
+                                                    command_type = EXECUTE;
+                                                    i = end - 1;
+                                                }
                                             }
                                             else {
                                                 print_error_location(error_info, "the label type \"%s\" requires a label name declaration before it's use", str);
@@ -378,9 +661,10 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                                         if(opcode_type != OPCODE_UNKOWN) { /* if opcode is valid */
                                             command_type = get_opcode_first_command(opcode_type);
                                             instruct = insert_new_instruction(machine->instructions_list, opcode_type);
-                                            if(machine->has_label && lbl != NULL) { /* if a label was declared then set it's type to LABEL_CODE */
-                                                label_set_type(lbl, LABEL_CODE);
-                                                label_set_IC(lbl, machine->IC);
+                                            instruction_set_line(instruct, error_location_get_line(error_info)); /* the second scan finds the instruction of every line by it */
+                                            if(machine->has_label && lbl != LABEL_NONE) { /* if a label was declared then set it's type to LABEL_CODE */
+                                                label_set_type(machine->labels_table, lbl, LABEL_CODE);
+                                                label_set_IC(machine->labels_table, lbl, machine->IC);
                                             }
                                             machine->IC++; /* the opcode is the first word of an instruction */
                                         }
@@ -394,9 +678,15 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                         }
                         else if(command_type == COMMAND_LABEL_VALUE) {
                             if(label_type == LABEL_DATA) { 
-                                if(is_integer(str)) { /* if the label type is LABEL_DATA then check if argument is an integer otherwise an error occurs */
-                                    add_new_data(machine, atoi(str), error_info); /* add the integer to the machine data array */
-                                    label_ascend_DC(lbl);
+                                if(is_integer(str) && is_integer_in_range(str, WORD_MIN_VALUE, WORD_MAX_VALUE) == false) { /* the integer must fit in the bits of a data word */
+                                    print_error_location(error_info, "the integer %s can't be stored in a data word, a data integer must be between %i and %i", str, WORD_MIN_VALUE, WORD_MAX_VALUE);
+                                    command_type = ERROR;
+                                }
+                                else if(is_integer(str)) { /* if the label type is LABEL_DATA then check if argument is an integer otherwise an error occurs */
+                                    if(add_new_data(machine, atoi(str), error_info) != false) /* add the integer to the machine data array */
+                                        label_ascend_DC(machine->labels_table, lbl);
+                                    else
+                                        command_type = ERROR;
                                 }
                                 else {
                                     print_error_location(error_info, "The parameter \"%s\" is not an integer", str);
@@ -433,7 +723,7 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                                 command_type = ERROR;
                         }
                         else if((command_type == COMMAND_DEST_OPERAND && (is_opcode_group_one(opcode_type) || (is_opcode_parameter_addresing(opcode_type) && instruction_get_addressing_parameter_status(instruct))))
-                                || (command_type == COMMAND_LABEL_VALUE && label_type == LABEL_DATA && label_get_DC(lbl) > 0 )) {
+                                || (command_type == COMMAND_LABEL_VALUE && label_type == LABEL_DATA && label_get_DC(machine->labels_table, lbl) > 0 )) {
                             if(comma_count > 1) {
                                 print_error_location(error_info, "Multiple consecutive comma");
                                 command_type = ERROR;                                
@@ -453,6 +743,11 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                         comma_count = 0; 
                         whitespace_count = 0;
                     }
+                    if(in_word != false && command_type != ERROR) { /* the rest of the word has no checks of its own, so it is copied with one lookup per character */
+                        while(CHAR_CLASS_OF(command[i + 1]) == CHAR_WORD)
+                            str[length++] = command[++i];
+                        str[length] = '\0';
+                    }
                 }
                 if(command_type == ERROR || is_end_null(c)) {
                     if(command_type != ERROR && command_type != EXECUTE) { /* if the command type is not ERROR or EXECUTE then a missing operand error occurs */
@@ -467,83 +762,104 @@ int assembler_first_scan(machine *machine, char input_path[]) {
                                 print_error_location(error_info, "missing a string declaration after the \".string\" statement");
                                 command_type = ERROR;
                             }
-                            else if(label_type == LABEL_DATA && label_get_DC(lbl) == 0) {
+                            else if(label_type == LABEL_DATA && label_get_DC(machine->labels_table, lbl) == 0) {
                                 print_error_location(error_info, "missing an integer declaration after the \".data\" statement");
                                 command_type = ERROR;
                             }
                         }
-                        else if(instruct != NULL) {
-                            print_error_location(error_info, NULL);
+                        else if(instruct != NULL) { /* the message is built first so it is printed as one error */
+                            message[0] = '\0';
                             if(is_opcode_parameter_addresing(opcode_type) && instruction_get_addressing_parameter_status(instruct)) {
                                 if(command_type == COMMAND_SOURCE_OPERAND)
-                                    printf("missing the first parameter");
+                                    strcat(message, "missing the first parameter");
                                 else if(command_type == COMMAND_DEST_OPERAND)
-                                    printf("missing the second parameter");
+                                    strcat(message, "missing the second parameter");
                             }
                             else {
-                                printf("missing the ");
+                                strcat(message, "missing the ");
                                 if(command_type == COMMAND_SOURCE_OPERAND) {
-                                    printf("source operand");
+                                    strcat(message, "source operand");
                                     if(is_opcode_group_one(opcode_type))
-                                        printf("and the ");
+                                        strcat(message, "and the ");
                                 }
-                                printf("destination operand"); 
+                                strcat(message, "destination operand"); 
                             }
-                            printf("\n");
+                            print_error_location(error_info, "%s", message);
                             command_type = ERROR;
                         }
                     }
                     break; /* stop reading the current line */
                 }
             }
-            if(command_type == ERROR) /* if the command type is ERROR then the function will return true */
+            if(command_type == ERROR) { /* if the command type is ERROR then the function will return true and the second scan skips the line */
                 error = true;
+                machine_add_failed_line(machine, error_location_get_line(error_info));
+            }
         }
     }
-    fclose(file); /* closes the file to insure safety */
-    free_error_location(error_info);
-    if(error != false) /* if the file have error then exit the function */
-        return true;
-    lbl = get_first_label(machine->labels_table);
-    while(lbl != NULL) { /* add to the data type labels the value of IC */
-        if(label_get_type(lbl) == LABEL_DATA || label_get_type(lbl) == LABEL_STRING)
-            label_set_IC(lbl, label_get_IC(lbl) + machine->IC);
-        lbl = get_next_label(lbl);
+    error_location_track_index(error_info, NULL);
+    return error;
+}
+
+void assembler_first_scan_finish(machine *machine) {
+    int lbl;
+    for(lbl = 0; lbl < label_table_get_count(machine->labels_table); lbl++) { /* add to the data type labels the value of IC */
+        if(label_get_type(machine->labels_table, lbl) == LABEL_DATA || label_get_type(machine->labels_table, lbl) == LABEL_STRING)
+            label_set_IC(machine->labels_table, lbl, label_get_IC(machine->labels_table, lbl) + machine->IC);
     }
     machine->initiated_labels = true; /* sets the first scan to be finished successfully and the label table had been built with no errors */
-    return false;
 }
 
 int assembler_second_scan(machine *machine, char input_path[]) {
+    int error;
+    line_reader *reader;
+    error_location *error_info; /* the error location to print when an error occurs */
+    FILE *file = open_file(input_path, ".am", "r"); /* read file */
+    if(file == NULL)
+        return true;
+    error_info = create_empty_error_location(get_file_full_name(input_path, ".am"));
+    error_location_set_diagnostics(error_info, machine->diagnostics);
+    reader = create_line_reader(file);
+    error = assembler_second_scan_lines(machine, reader, error_info);
+    free_line_reader(reader);
+    fclose(file); /* closes the file to insure safety */
+    free_error_location(error_info);
+    return error;
+}
+
+int assembler_second_scan_lines(machine *machine, line_reader *reader, error_location *error_info) {
     char command[MAX_COMMAND_LEN];
     char c;
     int error = false;
-    label *lbl = get_first_label(machine->labels_table); /* the current\next label in the file */
-    label *lbl_search; /* used to search for labels for entry operations */
+    int lbl_search; /* used to search for labels for entry operations and label declarations */
+    int failed = 0; /* the index of the next failed line of the first scan */
+    int line; /* the number of the current line */
     instruction *instruct = get_first_intruction(machine->instructions_list); /* the crrent\next instruction in the file */
     COMMAND_TYPE command_type; /* the current command type */
     OPCODE_TYPE opcode_type;
     LABEL_TYPE label_type;
     char str[MAX_COMMAND_LEN]; /* the current argument */
     int length = 0; /* the current argument length */
-    int i;
-    error_location *error_info; /* the error location to print when an error occurs */
-    FILE *file = open_file(input_path, ".am", "r"); /* read file */
-    if(file == NULL)
-        return true;
-    error_info = create_empty_error_location(get_file_full_name(input_path, ".am"));
+    int i = 0;
     machine->IC = IC_START; /* reset the words counter */
-    while((fgets(command, MAX_COMMAND_LEN, file)) != NULL) { /* read the file line by line */
+    error_location_track_index(error_info, &i); /* the index is read only when an error is printed */
+    while(error_location_limit_reached(error_info) == false && (line_reader_gets(reader, command, MAX_COMMAND_LEN)) != NULL) { /* read the file line by line until the maximum number of errors */
         error_location_ascend_line(error_info);
-        error_location_set_index(error_info, 0);
+        i = 0;
         command_type = COMMAND_LABEL_NAME;
         opcode_type = OPCODE_UNKOWN;
         label_type = LABEL_UNKOWN;
         str[0] = '\0';
         length = 0;
+        line = error_location_get_line(error_info);
+        while(failed < machine->failed_count && machine->failed_lines[failed] < line)
+            failed++;
+        if(failed < machine->failed_count && machine->failed_lines[failed] == line) /* the line had errors in the first scan, so it was already reported */
+            continue;
+        while(instruct != NULL && instruction_get_line(instruct) < line) /* skips the instructions of the lines that failed */
+            instruct = get_next_instruction(instruct);
         if(command[0] != ';') { /* comment lines are ignored */
             for(i = 0; i < MAX_COMMAND_LEN; i++) {
-                error_location_set_index(error_info, i);
                 c = command[i];
                 /* we checked in the first scan that every line doesn't have runtime errors therefore we don't need to check again: at EXECUTE or at null characters */
                 if(command_type != EXECUTE) {
@@ -554,6 +870,8 @@ int assembler_second_scan(machine *machine, char input_path[]) {
                         }
                         else {
                             str[length++] = c;
+                            while(CHAR_CLASS_OF(command[i + 1]) == CHAR_WORD) /* the rest of the word has no checks of its own, so it is copied with one lookup per character */
+                                str[length++] = command[++i];
                             str[length] = '\0';
                         }
                     }
@@ -561,13 +879,13 @@ int assembler_second_scan(machine *machine, char input_path[]) {
                         if(command_type == COMMAND_LABEL_NAME) {
                             if(label_type == LABEL_ENTRY) { /* if the first argument of the command is an entry declaration */
                                 lbl_search = search_in_label_table(machine->labels_table, str);
-                                if(lbl_search != NULL) { /* we know no errors were found in the first scan therefore we only nedd to check if the label name exists in the label table */
-                                    if(label_get_type(lbl_search) == LABEL_EXTERN) { /* if the label type was declared LABEL_EXTERN then an error occurs */
+                                if(lbl_search != LABEL_NONE) { /* we know no errors were found in the first scan therefore we only nedd to check if the label name exists in the label table */
+                                    if(label_get_type(machine->labels_table, lbl_search) == LABEL_EXTERN) { /* if the label type was declared LABEL_EXTERN then an error occurs */
                                         print_error_location(error_info, "label can't be extern and entry at the same time");
                                         command_type = ERROR;
                                     }
                                     else { /* we set the label as entry for the entry file (if no errors were found during the second scan) */
-                                        label_set_entry_status(lbl_search, true);
+                                        label_set_entry_status(machine->labels_table, lbl_search, true);
                                         machine->write_entry_file = true;
                                         command_type = EXECUTE;
                                     }
@@ -578,23 +896,16 @@ int assembler_second_scan(machine *machine, char input_path[]) {
                                 }
                             }
                             else if(str[length-1] == ':') { /* in the first scan we inserted every label into the label table and check the validity of the command */
-                                if(lbl != NULL) {
-                                    if(label_get_type(lbl) != LABEL_CODE) { /* if the label type is not LABEL_CODE we can skip this line becuase we checked the validity of the command in the first scan*/
-                                        lbl = get_next_label(lbl);
-                                        break;
-                                    }
-                                    lbl = get_next_label(lbl);
-                                }
-                                else
+                                str[length-1] = '\0';
+                                lbl_search = search_in_label_table(machine->labels_table, str);
+                                if(lbl_search == LABEL_NONE || label_get_type(machine->labels_table, lbl_search) != LABEL_CODE) /* if the label type is not LABEL_CODE we can skip this line becuase we checked the validity of the command in the first scan*/
                                     break;
                             } 
                             else { /* the argument must be a label data type declaration or an opcode */
                                 label_type = get_label_type(str);
                                 if(label_type != LABEL_UNKOWN) { /* if str is a label type */
-                                    if(label_type != LABEL_ENTRY) { /*if the label type is not entry then we checked the validity of them in the first scan, therefore we can skip them */
-                                        lbl = get_next_label(lbl);
+                                    if(label_type != LABEL_ENTRY) /*if the label type is not entry then we checked the validity of them in the first scan, therefore we can skip them */
                                         break;
-                                    }
                                 }
                                 else { /* if str is an opcode */
                                     opcode_type = instruction_get_opcode_type(instruct);
@@ -614,67 +925,217 @@ int assembler_second_scan(machine *machine, char input_path[]) {
             }
             if(command_type == ERROR) /* if the line had an error then the function will return true */
                 error = true;
-            if(opcode_type != OPCODE_UNKOWN && instruct != NULL) /* if the current line has an opcode then move to the next instruction */
+            if(opcode_type != OPCODE_UNKOWN && instruct != NULL) { /* if the current line has an opcode then move to the next instruction */
+                if(machine->instruction_listener != NULL) /* the operands of the instruction are final */
+                    machine->instruction_listener(machine->listener_context, instruct);
                 instruct = get_next_instruction(instruct);
+            }
         }
     }
-    fclose(file); /* closes the file to insure safety */
-    free_error_location(error_info);
+    error_location_track_index(error_info, NULL);
     return error;
 }
 
 int convert_to_machine_code(machine *machine, char *file_name) {
+    return write_machine_code(machine, file_name, NULL, IC_START, 0);
+}
+
+/**
+ * Writes the rows of one line of the .am file into a given listing: the line of the .as file, the line of the .am file, 
+ * the address and words of the first LISTING_ROW_WORDS words and the text of the line. 
+ * The other words are written in the next rows with only their address, so a long data statement keeps the columns.
+ * @param listing a given output buffer of the listing file.
+ * @param source_line the line of the .as file.
+ * @param line the line of the .am file.
+ * @param words the first word line of the line inside the object file text, as add_bits_to_buffer writes it.
+ * @param count the number of words of the line, can be 0.
+ * @param line_width the number of characters of the line numbers.
+ * @param address_width the number of digits of the word numbers of the object file.
+ * @param text the text of the line, without its new line character.
+ * @param length the number of characters of the text.
+*/
+void add_listing_rows(output_buffer *listing, int source_line, int line, char *words, int count, int line_width, int address_width, char *text, size_t length) {
+    char row[LISTING_ROW_SIZE]; /* the columns of a row before its text */
+    int size, column, number_length, i = 0;
+    do {
+        if(i == 0)
+            size = sprintf(row, "%*i %*i ", line_width, source_line, line_width, line);
+        else /* the next rows of the words have only their address */
+            size = sprintf(row, "%*s ", line_width * 2 + 1, "");
+        number_length = 0;
+        if(i < count) /* the address of the row is the word number of its first word line: a new line, the word number, 1 gap and the word */
+            for(; words[number_length + 1] != ' '; number_length++)
+                row[size + number_length] = words[number_length + 1];
+        for(column = number_length; column < address_width; column++)
+            row[size + column] = ' ';
+        size += address_width;
+        for(column = 0; column < LISTING_ROW_WORDS; column++) {
+            row[size++] = ' ';
+            if(i < count) {
+                for(words++; *words != ' '; words++) /* skip the new line and the word number */
+                    ;
+                memcpy(&row[size], words + 1, WORD_BIT);
+                words += WORD_BIT + 1; /* the new line of the next word line */
+                i++;
+            }
+            else
+                memset(&row[size], ' ', WORD_BIT);
+            size += WORD_BIT;
+        }
+        if(i <= LISTING_ROW_WORDS && length > 0) { /* only the first row has the text of the line */
+            output_buffer_write(listing, row, size);
+            output_buffer_puts(listing, "  ");
+            output_buffer_write(listing, text, length);
+        }
+        else { /* the empty columns at the end of the row are not written */
+            for(; size > 0 && row[size - 1] == ' '; size--)
+                ;
+            output_buffer_write(listing, row, size);
+        }
+        output_buffer_puts(listing, "\n");
+    } while(i < count);
+}
+
+/**
+ * Writes the listing file (.lst) of a given machine after its object file text was built: 
+ * a row for every line of the .am file with the line of the .as file it was written for, the address and the encoded words of its instruction or data statement. 
+ * The words are read from the object file text and the data statements are found by the declaration lines of their labels, so the lines are not scanned again. 
+ * The rows are written through a buffered writer.
+ * @param machine a given machine that converted its instructions.
+ * @param file_name a given file name without extension.
+ * @param words the first instruction word line inside the object file text.
+ * @param data the first data word line inside the object file text.
+ * @param address_width the number of digits of the word numbers of the object file.
+ * @returns true if the listing file was written, otherwise returns false
+*/
+int write_listing_file(machine *machine, char *file_name, char *words, char *data, int address_width) {
     instruction *instruct = get_first_intruction(machine->instructions_list);
-    label *lbl; /* the current label */
-    char *str; /* the binary representation of the data */
-    int i, j, line_num;
-    int IC = IC_START; /* to update the IC number in the object file */
-    FILE *file_object, *file_entry, *file_extern;
-    file_object = open_file(file_name, ".ob", "w"); /* write the object file */
-    if(file_object == NULL)
+    label_table *labels = machine->labels_table;
+    output_buffer *listing;
+    FILE *file;
+    size_t length, start, end, text_length;
+    int line = 0, lbl = 0, count, line_width, address, lines_count;
+    char *line_end;
+    char *text = read_text_file(file_name, ".am", &length);
+    if(text == NULL)
         return false;
-    fprintf(file_object , "%i %i", (machine->IC - IC_START), machine->DC); /* the first line includes the words and data count */
-    while(instruct != NULL) { /* add to file all the instructions words */
-        fprintf(file_object , "\n0%i %s", IC, get_first_word(instruct)); /* adds the number of the crrent word and the first word of the instruction */
-        IC++; /* the first word was added to file so increase IC by 1 */
-        get_other_words(file_object, instruct, &IC); /* add the other words (second, third and fourth) if they exist */
-        instruct = get_next_instruction(instruct);
-    }
-    str = empty_binary_dot();
-    if(str == NULL) /* checks if memory was allocated */
+    file = open_file(file_name, ".lst", "w");
+    if(file == NULL) {
+        free(text);
         return false;
-    for(i = 0; i < machine->DC; i++) { /* add to file all the data words */
-        for(j = 0; j < WORD_BIT; j++) /* reset binary dot for a safer approach */
-            str[j] = '.';
-        str[WORD_BIT] = '\0';
-        add_binary(str, 0, WORD_BIT, machine->data_array[i]); /* get the binary dot of the data word */
-        fprintf(file_object,"\n0%i %s", IC, str); /* adds the word to the file */
-        IC++;
     }
-    fclose(file_object);
-    line_num = 0;
+    listing = create_output_buffer(file);
+    lines_count = count_text_lines(text, length);
+    if(include_cache_get_source_line(machine->include_cache, lines_count) > lines_count) /* the source lines only grow, and the .as file can have more lines than the .am file */
+        lines_count = include_cache_get_source_line(machine->include_cache, lines_count);
+    for(line_width = 1; lines_count >= 10; lines_count /= 10)
+        line_width++;
+    if(line_width < LISTING_LINE_WIDTH)
+        line_width = LISTING_LINE_WIDTH;
+    for(start = 0; start < length; start = end + 1) {
+        line_end = (char*) memchr(&text[start], '\n', length - start);
+        end = line_end != NULL ? (size_t) (line_end - text) : length;
+        line++;
+        text_length = end > start && text[end - 1] == '\r' ? end - start - 1 : end - start; /* the new line of a line from windows is not a part of its text */
+        while(lbl < label_table_get_count(labels) && (label_get_line(labels, lbl) < line || 
+            (label_get_type(labels, lbl) != LABEL_DATA && label_get_type(labels, lbl) != LABEL_STRING))) /* the data labels are declared in the order of the lines */
+            lbl++;
+        if(instruct != NULL && instruction_get_line(instruct) == line) {
+            count = instruction_get_words_count(instruct);
+            add_listing_rows(listing, include_cache_get_source_line(machine->include_cache, line), line, words, count, line_width, address_width, &text[start], text_length);
+            words += get_words_length(count, address_width);
+            instruct = get_next_instruction(instruct);
+        }
+        else if(lbl < label_table_get_count(labels) && label_get_line(labels, lbl) == line) {
+            address = label_get_IC(labels, lbl) - machine->IC; /* the index of the first data word of the label, the data words start at words_IC */
+            add_listing_rows(listing, include_cache_get_source_line(machine->include_cache, line), line, &data[get_words_length(address, address_width)], 
+                label_get_DC(labels, lbl), line_width, address_width, &text[start], text_length);
+        }
+        else
+            add_listing_rows(listing, include_cache_get_source_line(machine->include_cache, line), line, NULL, 0, line_width, address_width, &text[start], text_length);
+    }
+    free_output_buffer(listing); /* writes the last block of the listing file */
+    fclose(file);
+    free(text);
+    return true;
+}
+
+int write_machine_code(machine *machine, char *file_name, output_buffer *instructions_words, int words_IC, int words_width) {
+    instruction *instruct = get_first_intruction(machine->instructions_list);
+    char header[MAX_COMMAND_LEN]; /* the first line of the object file */
+    int i, width;
+    int instructions_count = 0; /* the number of instructions to convert */
+    size_t header_length, words_length, length;
+    char *image; /* the whole object file text, written to the file at once */
+    char *position; /* the next character of the image to write the data words */
+    int written;
+    output_buffer *data; /* writes the data words into the image */
+    output_buffer *labels; /* the text of the entry or extern file */
+    sprintf(header, "%i %i", (machine->IC - IC_START), machine->DC); /* the first line includes the words and data count */
+    header_length = strlen(header);
+    if(instructions_words != NULL && words_width != get_address_width(words_IC + machine->DC - 1)) /* the words were converted with another width */
+        instructions_words = NULL;
+    if(instructions_words != NULL) /* the instructions were already converted */
+        words_length = output_buffer_get_length(instructions_words);
+    else { /* the instructions words numbers are known before converting them, so the lines length can be computed */
+        words_IC = IC_START;
+        for(; instruct != NULL; instruct = get_next_instruction(instruct)) {
+            words_IC += instruction_get_words_count(instruct);
+            instructions_count++;
+        }
+    }
+    width = get_address_width(words_IC + machine->DC - 1); /* every word number is written with the digits of the last one */
+    if(instructions_words == NULL)
+        words_length = get_words_length(words_IC - IC_START, width);
+    length = header_length + words_length + get_words_length(machine->DC, width);
+    image = (char*) malloc_and_check(length);
+    memcpy(image, header, header_length);
+    if(instructions_words != NULL)
+        memcpy(&image[header_length], output_buffer_get_text(instructions_words), words_length);
+    else /* add to the image all the instructions words */
+        machine->instructions_encoder(machine->encoder_context, &image[header_length], get_first_intruction(machine->instructions_list), instructions_count, IC_START, width);
+    position = &image[header_length + words_length];
+    data = create_block_output_buffer(write_text_block, &position);
+    for(i = 0; i < machine->DC; i++) /* add to the image all the data words, negative numbers are written in 2's complement as add_binary writes them */
+        add_bits_to_buffer(data, words_IC + i, width, machine->data_array[i] & WORD_MASK);
+    free_output_buffer(data);
+    written = write_text_file(file_name, ".ob", image, length, machine->keep_unchanged_outputs); /* write the object file */
+    if(written != false && machine->write_listing_file != false) /* the listing reads the words from the object file text */
+        written = write_listing_file(machine, file_name, &image[header_length], &image[header_length + words_length], width);
+    free(image);
+    if(written == false)
+        return false;
     if(machine->write_entry_file != false) { /* create entry file only if an entry label type was declared */
-        file_entry = open_file(file_name, ".ent", "w"); /* write the entry file */
-        if(file_entry == NULL)
+        labels = create_memory_output_buffer();
+        add_entries_to_buffer(labels, machine->labels_table);
+        written = write_text_file(file_name, ".ent", output_buffer_get_text(labels), output_buffer_get_length(labels), machine->keep_unchanged_outputs); /* write the entry file */
+        free_output_buffer(labels);
+        if(written == false)
             return false;
-        lbl = get_first_label(machine->labels_table);
-        while(lbl != NULL) {
-            add_entry_to_file(file_entry, lbl, &line_num);
-            lbl = get_next_label(lbl);
-        }
-        fclose(file_entry);
     }
-    line_num = 0;
     if(machine->write_extern_file != false) { /* create extern file only if an extern labels were used in instructions */
-        file_extern = open_file(file_name, ".ext", "w"); /* write the extern file */
-        if(file_extern == NULL)
+        labels = create_memory_output_buffer();
+        add_extern_uses_to_buffer(labels, machine->labels_table, machine->externs_by_address);
+        written = write_text_file(file_name, ".ext", output_buffer_get_text(labels), output_buffer_get_length(labels), machine->keep_unchanged_outputs); /* write the extern file */
+        free_output_buffer(labels);
+        if(written == false)
+            return false;
+    }
+    if(machine->write_symbol_file != false) { /* create the symbol file only if it was asked for */
+        labels = create_memory_output_buffer();
+        add_symbols_to_buffer(labels, machine->labels_table);
+        written = write_text_file(file_name, ".sym", output_buffer_get_text(labels), output_buffer_get_length(labels), machine->keep_unchanged_outputs); /* write the symbol file */
+        free_output_buffer(labels);
+        if(written == false)
+            return false;
+    }
+    if(machine->write_references_file != false) { /* create the cross-reference file only if it was asked for */
+        labels = create_memory_output_buffer();
+        add_references_to_buffer(labels, machine->labels_table);
+        written = write_text_file(file_name, ".xref", output_buffer_get_text(labels), output_buffer_get_length(labels), machine->keep_unchanged_outputs); /* write the cross-reference file */
+        free_output_buffer(labels);
+        if(written == false)
             return false;
-        lbl = get_first_label(machine->labels_table);
-        while(lbl != NULL) {
-            add_extern_list_to_file(file_extern, lbl, &line_num);
-            lbl = get_next_label(lbl);
-        }
-        fclose(file_extern);
     }
     return true;
 }
@@ -718,11 +1179,73 @@ int is_label_legal_format(char str[], error_location *error_info) {
     return true;
 }
 
-void add_new_data(machine *machine, int value, error_location *error_info) {
-    if(machine == NULL) return;
+int add_new_data(machine *machine, int value, error_location *error_info) {
+    if(machine == NULL) return false;
     if(machine->DC >= MAX_DATA) {
-        print_error_location(error_info, "the maximum number of data the machine can store from labels with the label type LABEL_DATA or LABEL_STRING is %i", MAX_DATA);
-        exit(0);
+        machine->data_overflow = true;
+        if(machine->is_chunk == false) /* a chunk is scanned again with the whole file to print the error where it occurs */
+            print_error_location(error_info, "the maximum number of data the machine can store from labels with the label type LABEL_DATA or LABEL_STRING is %i", MAX_DATA);
+        return false;
     }
+    machine_reserve_data(machine, 1);
     machine->data_array[machine->DC++] = value;
+    return true;
+}
+
+int add_data_values(machine *machine, char *command, int index, int lbl) {
+    char *c = &command[index];
+    int count = 0, digits, negative;
+    long value;
+    for(;;) { /* the integers are written after the current data and counted only when the whole statement is legal */
+        while(is_whitespace(*c))
+            c++;
+        negative = *c == '-';
+        if(*c == '+' || *c == '-')
+            c++;
+        for(value = 0, digits = 0; *c >= '0' && *c <= '9'; c++, digits++)
+            value = value * 10 + (*c - '0');
+        if(digits == 0 || digits > DATA_FAST_MAX_DIGITS || machine->DC + count >= MAX_DATA)
+            return -1;
+        if((negative ? -value : value) < WORD_MIN_VALUE || (negative ? -value : value) > WORD_MAX_VALUE) /* the scan writes the error of an integer that does not fit in a word */
+            return -1;
+        machine_reserve_data(machine, count + 1);
+        machine->data_array[machine->DC + count++] = (int) (negative ? -value : value);
+        while(is_whitespace(*c))
+            c++;
+        if(*c != ',')
+            break;
+        c++;
+    }
+    if(is_end_null(*c) == false)
+        return -1;
+    machine->DC += count;
+    label_add_DC(machine->labels_table, lbl, count);
+    return c - command;
+}
+
+int add_string_value(machine *machine, char *command, int index, int lbl) {
+    char *start = &command[index], *end;
+    int length, i;
+    while(is_whitespace(*start))
+        start++;
+    if(*start != '\"')
+        return -1;
+    start++;
+    end = strchr(start, '\"');
+    if(end == NULL || memchr(start, '\n', end - start) != NULL)
+        return -1;
+    length = end - start;
+    if(machine->DC + length + 1 > MAX_DATA) /* the string and its end null must fit */
+        return -1;
+    for(end++; is_whitespace(*end); end++)
+        ;
+    if(is_end_null(*end) == false)
+        return -1;
+    machine_reserve_data(machine, length + 1);
+    for(i = 0; i < length; i++)
+        machine->data_array[machine->DC + i] = start[i];
+    machine->data_array[machine->DC + length] = '\0';
+    machine->DC += length + 1;
+    label_add_DC(machine->labels_table, lbl, length + 1);
+    return end - command;
 }
\ No newline at end of file
@@ -3,9 +3,16 @@
 
 #include "instruction.h"
 #include "label.h"
+#include "pre_assembler.h"
 
-#define MAX_DATA 256 /* the maximum number of data that a file can contain (maximum number for the DC counter) */
+#define MAX_DATA (1 << 24) /* the maximum number of data that a file can contain (maximum number for the DC counter) */
+#define DATA_START_SIZE 256 /* the first size of the data array of a machine, it is doubled every time the data does not fit */
 #define IC_START 100 /* the first value of the IC counter */
+#define DATA_FAST_MAX_DIGITS 9 /* the most digits of an integer that add_data_values converts, a longer integer is converted by atoi in the scan */
+#define LISTING_ROW_WORDS 4 /* the maximum number of words in a row of the listing file, the number of words of the longest instruction */
+#define LISTING_LINE_WIDTH 5 /* the minimum number of characters of the line numbers of a row of the listing file */
+#define LISTING_ROW_SIZE 128 /* the number of characters the columns of a listing row can take: 2 line numbers and an address of at most 12 characters each and LISTING_ROW_WORDS words */
+#define FAILED_LINES_START_SIZE 64 /* the first size of the failed lines array of a machine, it is doubled every time the array is full */
 
 /**
  * An enum used for determining the current step to scan lines for a given file.
@@ -29,16 +36,38 @@ typedef enum COMMAND_TYPE
 */
 typedef struct machine_t machine;
 
+/**
+ * A function that the second scan calls with a given context for every instruction that its operands are final.
+*/
+typedef void (*instruction_listener)(void *context, instruction *instruct);
+
+/**
+ * A scan of the lines of a given line reader with a given machine: assembler_first_scan_lines or assembler_second_scan_lines.
+*/
+typedef int (*lines_scan)(machine *machine, line_reader *reader, error_location *error_info);
+
 /**
  * Activates the pre assembler, first assembler scan, second assembler scan 
  * and the conversion from machine to code.
- * At the end of each step, if an error occurs then exit the function.
+ * Every step runs even if the steps before it had errors, so all the errors of the file are printed in one run, 
+ * the lines with errors are skipped by the next steps and the machine code is converted only if no step had errors.
+ * If the .as or .am file can't be opened then the next steps don't run.
  * @param machine the current machine to use.
  * @param file_name a given file name without extension.
  * @returns false\0 if an error occurs, returns true\1 otherwise.
 */
 int full_assembler(machine *machine, char *file_name);
 
+/**
+ * Checks a given file the same way full_assembler does without writing any file: 
+ * the pre assembler expands the lines into memory and both scans read them from there, and the machine code is not converted. 
+ * The errors are the same errors full_assembler finds, with the same locations.
+ * @param machine the current machine to use.
+ * @param file_name a given file name without extension.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int syntax_only_assembler(machine *machine, char *file_name);
+
 /**
  * Creates a new machine and initaite its data by resetting the machine.
  * @returns the newly created machine.
@@ -52,6 +81,154 @@ machine *initialize_machine();
 */
 void reset_machine(machine *machine);
 
+/**
+ * Sets the function that converts the instructions of a given machine into the object file lines of their words.
+ * @param machine a given machine.
+ * @param encoder a given instructions encoder, if NULL then encode_instructions is used.
+ * @param context the context that the encoder receives.
+*/
+void machine_set_instructions_encoder(machine *machine, instructions_encoder encoder, void *context);
+
+/**
+ * Sets the order of the extern file lines of a given machine.
+ * @param machine a given machine.
+ * @param sorted_by_address if true\1 then the lines are written by their word numbers, otherwise they are grouped by their label.
+*/
+void machine_set_externs_order(machine *machine, int sorted_by_address);
+
+/**
+ * Replaces the diagnostics of a given machine with empty diagnostics of a given format and maximum number of errors. 
+ * Every step of the assembler adds the errors of the file into the diagnostics of the machine, and they are written when they are flushed.
+ * @param machine a given machine.
+ * @param format the format to write the errors with.
+ * @param max_errors the maximum number of errors of a file, after it the scans stop, DIAGNOSTICS_UNLIMITED for no limit.
+*/
+void machine_set_diagnostics_format(machine *machine, DIAGNOSTICS_FORMAT format, int max_errors);
+
+/**
+ * Returns the diagnostics that contain the errors of the current file of a given machine.
+ * @param machine a given machine.
+ * @returns the diagnostics, if machine is NULL then returns NULL.
+*/
+diagnostics *machine_get_diagnostics(machine *machine);
+
+/**
+ * Sets the macro prelude that the pre assembler of a given machine searches after the macros of every file. 
+ * The prelude is only read, so the same prelude can be set to every machine and used on every thread, and the machine does not free it.
+ * @param machine a given machine.
+ * @param prelude a given macro table, can be NULL.
+*/
+void machine_set_prelude(machine *machine, macro_table *prelude);
+
+/**
+ * Returns the macro prelude of a given machine.
+ * @param machine a given machine.
+ * @returns the macro prelude, returns NULL if the machine has no prelude or the machine is NULL.
+*/
+macro_table *machine_get_prelude(machine *machine);
+
+/**
+ * Sets the include cache that the pre assembler of a given machine shares the included files of every file with. 
+ * The machine does not free the cache, and only one machine can use it at a time.
+ * @param machine a given machine.
+ * @param cache a given include cache, can be NULL.
+*/
+void machine_set_include_cache(machine *machine, include_cache *cache);
+
+/**
+ * Returns the include cache of a given machine.
+ * @param machine a given machine.
+ * @returns the include cache, returns NULL if the machine has no include cache or the machine is NULL.
+*/
+include_cache *machine_get_include_cache(machine *machine);
+
+/**
+ * Sets if a given machine writes only the output files that their text changed, so the unchanged files keep their modification time.
+ * @param machine a given machine.
+ * @param status true\1 if the unchanged output files are kept, false\0 if every output file is written.
+*/
+void machine_set_keep_unchanged_outputs(machine *machine, int status);
+
+/**
+ * Sets if a given machine writes the symbol file (.sym) of every label with the object file, as add_symbols_to_buffer writes it.
+ * @param machine a given machine.
+ * @param status true\1 to write the symbol file, false\0 otherwise.
+*/
+void machine_set_symbol_file(machine *machine, int status);
+
+/**
+ * Sets if a given machine keeps the uses of the labels as operands in the second scan 
+ * and writes the cross-reference file (.xref) with the object file, as add_references_to_buffer writes it.
+ * @param machine a given machine.
+ * @param status true\1 to write the cross-reference file, false\0 otherwise.
+*/
+void machine_set_references_file(machine *machine, int status);
+
+/**
+ * Sets if a given machine writes the listing file (.lst) of the source lines and their words with the object file. 
+ * The include cache of the machine must keep the source lines of the expanded lines for the lines of the .as file.
+ * @param machine a given machine.
+ * @param status true\1 to write the listing file, false\0 otherwise.
+*/
+void machine_set_listing_file(machine *machine, int status);
+
+/**
+ * Returns the width of the word numbers of the object file of a given machine that finished its first scan, 
+ * from the last word number its counters give (see get_address_width).
+ * @param machine a given machine.
+ * @returns the number of digits of the word numbers.
+*/
+int machine_get_address_width(machine *machine);
+
+/**
+ * Sets if a given machine scans only a chunk of a file: 
+ * a chunk machine records that its data overflowed instead of reporting the error.
+ * @param machine a given machine.
+ * @param status true\1 if the machine scans a chunk, false\0 otherwise.
+*/
+void machine_set_chunk_status(machine *machine, int status);
+
+/**
+ * Moves the labels, instructions and data of a given chunk machine that finished its first scan commands to the end of a given machine. 
+ * The IC of the code labels and the DC of the data labels are rebased by the counters of the machine before the chunk.
+ * The failed lines of the chunk are added to the failed lines of the machine.
+ * Nothing is moved if a label of the chunk was already declared in the machine or if the data of both machines does not fit in MAX_DATA.
+ * @param main_machine a given machine.
+ * @param chunk a given chunk machine.
+ * @param keep_chunk if true\1 then the instructions of the chunk are copied and the chunk stays unchanged, so it can be merged again.
+ * @returns true\1 if the chunk was merged, returns false\0 otherwise.
+*/
+int machine_merge_chunk(machine *main_machine, machine *chunk, int keep_chunk);
+
+/**
+ * Adds a given number to the line numbers of the instructions and failed lines of a given chunk machine, 
+ * used when the lines before a kept chunk were added or removed.
+ * @param chunk a given chunk machine.
+ * @param delta the number to add to every line number.
+*/
+void machine_shift_lines(machine *chunk, int delta);
+
+/**
+ * Records a given line number as a line that had errors in the first scan of a given machine, the lines must be recorded in ascending order.
+ * @param machine a given machine.
+ * @param line the number of the line.
+*/
+void machine_add_failed_line(machine *machine, int line);
+
+/**
+ * Free the memory a given machine contains from the system memory.
+ * @param machine a given machine.
+*/
+void free_machine(machine *machine);
+
+/**
+ * Sets the function that the second scan of a given machine calls for every instruction that its operands are final.
+ * @param machine a given machine.
+ * @param listener a given instruction listener, if NULL then no function is called.
+ * @param context the context that the listener receives.
+*/
+void machine_set_instruction_listener(machine *machine, instruction_listener listener, void *context);
+
 /**
  * Checks if a given command type or a given instruction is used for addressing parameters 
  * and builds the instruction according to the command type.
@@ -84,23 +261,58 @@ void process_operand(char str[], machine *machine, instruction *instruct, COMMAN
  * Process the file to check if error exists, and if not then insert instructions and labels into the machine. 
  * In the first scan only the runtime errors can be found therefore when a label operand is being checked then check only if it is legal. 
  * The first scan also builds the label and instructions table, and the label operands of the instruction will be processed in the second scan if no errors are to be found in this function. 
- * If an error occrs then print it's message.
+ * If an error occrs then print it's message, record the line as failed so the second scan skips it and continue to the next line.
  * @param machine a given machine to use
  * @param input_path the file name without extension
  * @returns false if the file does not have errors, retrns true otherwise
 */
 int assembler_first_scan(machine *machine, char input_path[]);
 
+/**
+ * Does the first scan on the lines of a given line reader, as assembler_first_scan does with the .am file.
+ * @param machine a given machine to use
+ * @param reader a given line reader of the expanded lines
+ * @param error_info the error location to print the errors with
+ * @returns false if the lines does not have errors, retrns true otherwise
+*/
+int assembler_first_scan_lines(machine *machine, line_reader *reader, error_location *error_info);
+
+/**
+ * Does the first scan on the lines of a given line reader without the final step of assembler_first_scan_lines, 
+ * so the labels are not initiated and the data labels values are relative to the start of the data.
+ * @param machine a given machine to use
+ * @param reader a given line reader of the expanded lines
+ * @param error_info the error location to print the errors with
+ * @returns false if the lines does not have errors, retrns true otherwise
+*/
+int assembler_first_scan_commands(machine *machine, line_reader *reader, error_location *error_info);
+
+/**
+ * The final step of the first scan: adds the IC of a given machine to its data labels and sets its labels as initiated.
+ * @param machine a given machine to use
+*/
+void assembler_first_scan_finish(machine *machine);
+
 /**
  * Process the file to check if error exists, and if not then update the machine code to include labels as operands. 
  * Beacuse the first scan checks for runtime error and can't check for label operands bcause the label table had not been yet fully initiated, 
- * then the the file will be scan for a second time to check for label operands errors, and checks for entry declaration for labels and set them as entry.
+ * then the the file will be scan for a second time to check for label operands errors, and checks for entry declaration for labels and set them as entry. 
+ * The lines that failed in the first scan are skipped, therefore the second scan can run after a first scan with errors.
  * @param machine a given machine to use
  * @param input_path the file name without extension
  * @returns false if the file does not have errors, retrns true otherwise
 */
 int assembler_second_scan(machine *machine, char input_path[]);
 
+/**
+ * Does the second scan on the lines of a given line reader, as assembler_second_scan does with the .am file.
+ * @param machine a given machine to use
+ * @param reader a given line reader of the expanded lines
+ * @param error_info the error location to print the errors with
+ * @returns false if the lines does not have errors, retrns true otherwise
+*/
+int assembler_second_scan_lines(machine *machine, line_reader *reader, error_location *error_info);
+
 /**
  * Converts the code into machine code, create object, entry and extern file only if the first and second scan were successfully completed without error.
  * @param machine the current machine
@@ -109,6 +321,24 @@ int assembler_second_scan(machine *machine, char input_path[]);
 */
 int convert_to_machine_code(machine *machine, char *file_name);
 
+/**
+ * Creates the object, entry and extern files of a given machine. 
+ * The object file is built in memory as one text and written at once: the length of every line is known from the words numbers, 
+ * so the text is allocated before the words are converted into it. 
+ * If the instructions words were already converted into a given memory output buffer then they are copied into the object file, 
+ * otherwise the instructions are converted with the instructions encoder of the machine. 
+ * The entry and extern files are also built in memory, and if the machine keeps unchanged outputs then only the files that their text changed are written.
+ * The listing file takes the words from the object file text before it is freed, so the instructions are not converted again.
+ * @param machine the current machine
+ * @param file_name a given file name without extension
+ * @param instructions_words a given memory output buffer with the converted instructions words, can be NULL.
+ * @param words_IC the IC after the last converted instruction word, only used when instructions_words is not NULL.
+ * @param words_width the width of the word numbers the instructions words were converted with, only used when instructions_words is not NULL. 
+ * If it is not the width of the last word number of the file then the instructions are converted again.
+ * @returns true if the creation was successfully completed, otherwise returns false
+*/
+int write_machine_code(machine *machine, char *file_name, output_buffer *instructions_words, int words_IC, int words_width);
+
 /**
  * Checks for the first command type to process the instruction second word (if not group 3) according to the opcode type. 
  * group 3 have only one word therefore the next command type is EXECUTE
@@ -129,11 +359,37 @@ int is_label_legal_format(char str[], error_location *error_info);
 
 /**
  * Adds new data to the data array of a given machine. 
- * If the number of data in the machine (DC) is bigger\equal to MAX_DATA then an error occurs and exists the program.
+ * If the number of data in the machine (DC) is bigger\equal to MAX_DATA then an error occurs and the value is not added, 
+ * a chunk machine records the overflow instead of printing the error.
  * @param machine a given machine.
  * @param value a given value.
  * @param error_info the current error location info.
+ * @returns true\1 if the value was added, returns false\0 otherwise.
+*/
+int add_new_data(machine *machine, int value, error_location *error_info);
+
+/**
+ * Converts the integers of a .data statement in one pass and adds them to the data array of a given machine and to the DC of a given label at once. 
+ * Only a statement without errors is added: integers separated by single commas with optional whitespace characters, that fit in MAX_DATA. 
+ * Otherwise nothing is added, so the line can be scanned character by character and its errors are found where they occur.
+ * @param machine a given machine.
+ * @param command the current line.
+ * @param index the index of the first character after the .data statement.
+ * @param lbl the id of the label of the statement.
+ * @returns the index of the end of the line if the integers were added, returns -1 otherwise.
+*/
+int add_data_values(machine *machine, char *command, int index, int lbl);
+
+/**
+ * Copies the characters of a .string statement and its end null to the data array of a given machine and adds them to the DC of a given label at once. 
+ * Only a statement without errors is added: a string between quotes with optional whitespace characters around it, that fits in MAX_DATA. 
+ * Otherwise nothing is added, so the line can be scanned character by character and its errors are found where they occur.
+ * @param machine a given machine.
+ * @param command the current line.
+ * @param index the index of the first character after the .string statement.
+ * @param lbl the id of the label of the statement.
+ * @returns the index of the end of the line if the string was added, returns -1 otherwise.
 */
-void add_new_data(machine *machine, int value, error_location *error_info);
+int add_string_value(machine *machine, char *command, int index, int lbl);
 
 #endif
\ No newline at end of file
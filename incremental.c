@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incremental.h"
+#include "pre_assembler.h"
+#include "utils.h"
+
+/**
+ * A data structure used for one segment of lines of the .am file and the chunk machine that scanned it.
+*/
+typedef struct model_segment
+{
+    char *text; /* the lines of the segment, inside the text of the model */
+    size_t length; /* the number of characters of the segment */
+    unsigned long hash; /* the hash of the segment text */
+    int first_line; /* the number of lines the first scan reads before the segment */
+    int lines_count; /* the number of lines the first scan reads in the segment */
+    machine *machine; /* the chunk machine that scanned the segment, NULL if the segment was not scanned yet */
+    int error; /* true\1 if the segment has errors */
+} model_segment;
+
+struct assembly_model_t
+{
+    char *text; /* the .am text of the last scan */
+    model_segment *segments; /* the segments of the text in their order */
+    int count; /* the number of segments */
+};
+
+assembly_model *create_assembly_model() {
+    assembly_model *model = (assembly_model*) malloc_and_check(sizeof(assembly_model));
+    model->text = NULL;
+    model->segments = NULL;
+    model->count = 0;
+    return model;
+}
+
+/**
+ * Splits a given text into segments: a segment ends after a line that its hash is divided by INCREMENTAL_BOUNDARY
+ * when it has at least INCREMENTAL_MIN_SEGMENT_LINES lines, or when it has INCREMENTAL_MAX_SEGMENT_LINES lines.
+ * The segments end only after new line characters, so their lines are the same lines the whole text has.
+ * @param text a given text.
+ * @param length the number of characters inside the text.
+ * @param count a pointer to store the number of segments.
+ * @returns the newly created array of segments, without machines.
+*/
+model_segment *split_segments(char *text, size_t length, int *count) {
+    int size = INCREMENTAL_SEGMENTS_START_SIZE;
+    model_segment *segments = (model_segment*) malloc_and_check(sizeof(model_segment) * size);
+    size_t start = 0, end;
+    int lines, first_line = 0;
+    char *line_end;
+    *count = 0;
+    while(start < length) {
+        end = start;
+        lines = 0;
+        while(end < length) { /* add lines until a boundary line */
+            line_end = (char*) memchr(&text[end], '\n', length - end);
+            line_end = line_end != NULL ? line_end + 1 : &text[length];
+            lines++;
+            if((lines >= INCREMENTAL_MIN_SEGMENT_LINES && hash_text(HASH_START, &text[end], line_end - &text[end]) % INCREMENTAL_BOUNDARY == 0)
+                || lines == INCREMENTAL_MAX_SEGMENT_LINES) {
+                end = line_end - text;
+                break;
+            }
+            end = line_end - text;
+        }
+        if(*count == size) {
+            size *= 2;
+            segments = (model_segment*) realloc_and_check(segments, sizeof(model_segment) * size);
+        }
+        segments[*count].text = &text[start];
+        segments[*count].length = end - start;
+        segments[*count].hash = hash_text(HASH_START, &text[start], end - start);
+        segments[*count].first_line = first_line;
+        segments[*count].lines_count = count_text_lines(&text[start], end - start);
+        segments[*count].machine = NULL;
+        segments[*count].error = false;
+        first_line += segments[*count].lines_count;
+        (*count)++;
+        start = end;
+    }
+    return segments;
+}
+
+/**
+ * Checks if 2 given segments have the same text.
+ * @param segment a given segment.
+ * @param other a given segment.
+ * @returns true\1 if the segments have the same text, returns false\0 otherwise.
+*/
+int is_same_segment(model_segment *segment, model_segment *other) {
+    return segment->length == other->length && segment->hash == other->hash && memcmp(segment->text, other->text, segment->length) == 0;
+}
+
+/**
+ * Moves the chunk machine of a given old segment with the same text to a given segment if it can be kept:
+ * the machine is kept if the errors it found have the same format, and if the segment has no errors or its lines did not move.
+ * @param machine the machine the segments are merged into.
+ * @param segment a given segment.
+ * @param old the segment with the same text from the last scan.
+*/
+void keep_segment(machine *machine, model_segment *segment, model_segment *old) {
+    diagnostics *diag = machine_get_diagnostics(machine), *old_diag;
+    if(old->machine == NULL)
+        return;
+    old_diag = machine_get_diagnostics(old->machine);
+    if(diagnostics_get_format(old_diag) != diagnostics_get_format(diag) || diagnostics_get_max_errors(old_diag) != diagnostics_get_max_errors(diag))
+        return;
+    if(old->error != false && old->first_line != segment->first_line) /* the errors were written with the old line numbers */
+        return;
+    machine_shift_lines(old->machine, segment->first_line - old->first_line);
+    segment->machine = old->machine;
+    segment->error = old->error;
+    old->machine = NULL;
+}
+
+/**
+ * Does the first scan commands of a given segment with a new chunk machine.
+ * @param machine the machine that the chunk machine takes its errors format from.
+ * @param segment a given segment.
+ * @param file_name the file name without extension.
+*/
+void scan_segment(machine *machine, model_segment *segment, char *file_name) {
+    text_reader lines;
+    line_reader *reader;
+    error_location *error_info;
+    diagnostics *diag = machine_get_diagnostics(machine);
+    lines.text = segment->text;
+    lines.length = segment->length;
+    lines.position = 0;
+    segment->machine = initialize_machine();
+    machine_set_chunk_status(segment->machine, true);
+    machine_set_diagnostics_format(segment->machine, diagnostics_get_format(diag), diagnostics_get_max_errors(diag));
+    reader = create_block_line_reader(read_text_block, &lines);
+    error_info = create_empty_error_location(get_file_full_name(file_name, ".am"));
+    error_location_set_diagnostics(error_info, machine_get_diagnostics(segment->machine));
+    error_location_set_line(error_info, segment->first_line);
+    segment->error = assembler_first_scan_commands(segment->machine, reader, error_info);
+    free_error_location(error_info);
+    free_line_reader(reader);
+}
+
+/**
+ * Frees the chunk machines and the array of given segments.
+ * @param segments a given array of segments.
+ * @param count the number of segments.
+*/
+void free_segments(model_segment *segments, int count) {
+    int i;
+    for(i = 0; i < count; i++)
+        free_machine(segments[i].machine);
+    free(segments);
+}
+
+int incremental_first_scan(machine *machine, assembly_model *model, char *file_name) {
+    model_segment *segments;
+    int count, first, last, i;
+    int merged = true; /* false if the segments could not be merged and the file must be scanned again */
+    int error = false;
+    size_t length;
+    char *text = read_text_file(file_name, ".am", &length);
+    if(text == NULL)
+        return true;
+    if(diagnostics_limit_reached(machine_get_diagnostics(machine))) { /* a file that reached the maximum number of errors is not scanned */
+        free(text);
+        return assembler_first_scan(machine, file_name);
+    }
+    segments = split_segments(text, length, &count);
+    for(first = 0; first < count && first < model->count && is_same_segment(&segments[first], &model->segments[first]); first++) /* the segments before the edit */
+        keep_segment(machine, &segments[first], &model->segments[first]);
+    for(last = 1; last <= count - first && last <= model->count - first && is_same_segment(&segments[count - last], &model->segments[model->count - last]); last++) /* the segments after the edit */
+        keep_segment(machine, &segments[count - last], &model->segments[model->count - last]);
+    for(i = 0; i < count; i++)
+        if(segments[i].machine == NULL)
+            scan_segment(machine, &segments[i], file_name);
+    free_segments(model->segments, model->count); /* the machines that were not kept belong to lines that changed */
+    free(model->text);
+    model->text = text;
+    model->segments = segments;
+    model->count = count;
+    for(i = 0; i < count && merged != false; i++) {
+        merged = machine_merge_chunk(machine, segments[i].machine, true);
+        error = error || segments[i].error;
+    }
+    if(merged == false) { /* a label was declared in 2 segments or the data overflowed, the errors are found by scanning the whole file */
+        reset_machine(machine);
+        return assembler_first_scan(machine, file_name);
+    }
+    for(i = 0; i < count; i++) /* the errors of every segment are added in the order of the lines, until the maximum number of errors */
+        diagnostics_append(machine_get_diagnostics(machine), machine_get_diagnostics(segments[i].machine));
+    assembler_first_scan_finish(machine); /* the labels are initiated even if the file has errors, so the second scan can check the other lines */
+    return error;
+}
+
+int incremental_assembler(machine *machine, assembly_model *model, char *file_name) {
+    int error = pre_assembler(file_name, machine_get_diagnostics(machine), machine_get_prelude(machine), machine_get_include_cache(machine));
+    if(error == PRE_ASSEMBLER_NO_FILE)
+        return false;
+    if(incremental_first_scan(machine, model, file_name) != false) /* every step runs so all the errors are printed, as full_assembler does */
+        error = true;
+    if(assembler_second_scan(machine, file_name) != false)
+        error = true;
+    if(error != false)
+        return false;
+    return convert_to_machine_code(machine, file_name);
+}
+
+void free_assembly_model(assembly_model *model) {
+    if(model == NULL)
+        return;
+    free_segments(model->segments, model->count);
+    free(model->text);
+    free(model);
+}
@@ -0,0 +1,56 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "assembler.h"
+
+#define INCREMENTAL_MIN_SEGMENT_LINES 64 /* the minimum number of lines in a segment, only the last segment of a file can be shorter */
+#define INCREMENTAL_MAX_SEGMENT_LINES 2048 /* the maximum number of lines in a segment */
+#define INCREMENTAL_BOUNDARY 128 /* a segment ends after a line that its hash is divided by this number, so the boundaries depend only on the lines around them */
+#define INCREMENTAL_SEGMENTS_START_SIZE 64 /* the first number of segments a model can contain, it is doubled every time the array is full */
+
+/**
+ * A data structure used for keeping the first scan of a file between its assemblies:
+ * the .am text is split into segments of lines and every segment keeps the chunk machine that scanned it,
+ * so when the file is assembled again only the segments that their lines changed are scanned.
+*/
+typedef struct assembly_model_t assembly_model;
+
+/**
+ * Creates an empty assembly model, the first assembly with it scans every segment.
+ * @returns the newly created assembly model.
+*/
+assembly_model *create_assembly_model();
+
+/**
+ * Does the first assembler scan of a given file the same way assembler_first_scan does,
+ * but scans only the segments of the .am file that changed since the last scan with a given model.
+ * The segments are split after the lines that their hash is divided by INCREMENTAL_BOUNDARY, so an edit moves only the boundaries near it.
+ * The segments at the start and at the end of the file that are the same as in the last scan keep their chunk machines:
+ * the line numbers of the segments after the edit are moved, and a segment with errors is scanned again if its lines moved, so its errors have the new line numbers.
+ * The chunk machines are merged into the machine the same way parallel_first_scan merges them, and they are kept in the model.
+ * If a label was declared in 2 segments or the data does not fit in MAX_DATA then the file is scanned again without segments.
+ * @param machine a given machine to use.
+ * @param model the model of the file, updated to the current text.
+ * @param file_name a given file name without extension.
+ * @returns false if the file does not have errors, retrns true otherwise
+*/
+int incremental_first_scan(machine *machine, assembly_model *model, char *file_name);
+
+/**
+ * Activates the pre assembler, first assembler scan, second assembler scan
+ * and the conversion from machine to code, the same way full_assembler does,
+ * but the first scan is done with incremental_first_scan and a given model.
+ * @param machine the current machine to use.
+ * @param model the model of the file.
+ * @param file_name a given file name without extension.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int incremental_assembler(machine *machine, assembly_model *model, char *file_name);
+
+/**
+ * Free the memory a given assembly model contains from the system memory.
+ * @param model a given assembly model.
+*/
+void free_assembly_model(assembly_model *model);
+
+#endif
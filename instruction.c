@@ -1,16 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "instruction.h"
-
-/**
- * An enum used for identifying the encoding for every machine word.
-*/
-typedef enum ENCODING_TYPE
-{
-    ENCODING_A, /* used for encoding direct operand words */
-    ENCODING_E, /* used for encoding external labels */
-    ENCODING_R /* used for encoding relocatable words: local labels in a given file that are not extern */
-} ENCODING_TYPE;
+#include "memory.h"
 
 struct instruction_t
 {
@@ -21,6 +12,7 @@ struct instruction_t
     int input_p; /* this operand is used as the first parameter for addressing parameter opcode instructions, otherise as input operand */
     int output_p; /* this operand is used as the second parameter for addressing parameter opcode instructions, otherise as output operand */
     unsigned is_addressing_parameter:1; /* check if the instruction is addressing parameter: input_p and output_p will be used as 2 parameters */
+    int line; /* the line of the .am file that the instruction was declared in */
     struct instruction_t *next; /* the next instruction */
 };
 
@@ -31,7 +23,7 @@ struct instruction_list
 };
 
 instruction *create_instruction(OPCODE_TYPE opcode_type) {
-    instruction *instrct = (instruction*) malloc_and_check(sizeof(instruction));
+    instruction *instrct = (instruction*) malloc_counted(sizeof(instruction), MEMORY_INSTRUCTIONS);
     instrct->opcode = opcode_type;
     instrct->label_p = 0;    
     instrct->input_a = ADRESSING_UNKOWN;
@@ -39,12 +31,13 @@ instruction *create_instruction(OPCODE_TYPE opcode_type) {
     instrct->output_a = ADRESSING_UNKOWN;
     instrct->output_p = 0;
     instrct->is_addressing_parameter = false;
+    instrct->line = 0;
     instrct->next = NULL;
     return instrct;
 }
 
 instruction_list* create_empty_instruction_list() {
-    instruction_list *list = (instruction_list*) malloc_and_check(sizeof(instruction_list));
+    instruction_list *list = (instruction_list*) malloc_counted(sizeof(instruction_list), MEMORY_INSTRUCTIONS);
     list->head = NULL;
     list->root = NULL;
     return list;
@@ -62,6 +55,27 @@ instruction *insert_new_instruction(instruction_list *list, OPCODE_TYPE opcode_t
     return root;
 }
 
+void instruction_list_append(instruction_list *list, instruction_list *other) {
+    if(list == NULL || other == NULL || other->head == NULL) return;
+    if(list->head == NULL)
+        list->head = other->head;
+    else
+        list->root->next = other->head;
+    list->root = other->root;
+    other->head = NULL;
+    other->root = NULL;
+}
+
+void instruction_list_append_copy(instruction_list *list, instruction_list *other) {
+    instruction *instruct, *copy;
+    if(list == NULL || other == NULL) return;
+    for(instruct = other->head; instruct != NULL; instruct = instruct->next) {
+        copy = insert_new_instruction(list, instruct->opcode);
+        *copy = *instruct;
+        copy->next = NULL;
+    }
+}
+
 OPCODE_TYPE instruction_get_opcode_type(instruction *instruct) {
     return instruct != NULL ? instruct->opcode : OPCODE_UNKOWN;
 }
@@ -104,6 +118,15 @@ void instruction_set_addressing_parameter_status(instruction *instruct, int addr
         instruct->is_addressing_parameter = addressing_parameter_status;
 }
 
+int instruction_get_line(instruction *instruct) {
+    return instruct != NULL ? instruct->line : 0;
+}
+
+void instruction_set_line(instruction *instruct, int line) {
+    if(instruct != NULL)
+        instruct->line = line;
+}
+
 instruction *get_next_instruction(instruction *instruct) {
     return instruct != NULL ? instruct->next : NULL;
 }
@@ -112,105 +135,146 @@ instruction *get_first_intruction(instruction_list *list) {
     return list != NULL ? list->head : NULL;
 }
 
-char *get_first_word(instruction *instrct) {
-    OPCODE_TYPE opcode;
-    ADDRESSING_MODE addressing_type = 0;
-    char *str;
-    if(instrct == NULL)
-        return NULL;
-    str = empty_binary_dot();
-    opcode = instrct->opcode;
-    if(is_opcode_parameter_addresing(opcode)) { /* if the opcode is parameter addressing opcodes then check if the label is addressing parameters or not */
-        if(instrct->is_addressing_parameter) {
-            add_binary(str, 0, 2, instrct->input_a);
-            add_binary(str, 2, 2, instrct->output_a);
-            addressing_type = ADDRESSING_PARAMATER;
-        }
-        else
-            addressing_type = ADDRESSING_DIRECT;
-        add_binary(str, ADDRESSING_DESTINATION_BIT, 2, addressing_type);
-    }
-    else {
-        if(!is_opcode_group_three(opcode)) { /* group 3 opcodes don't have operands */
-            if(!is_opcode_group_two(opcode)) { /* group 1 opcodes have 2 operands */
-                add_binary(str, ADDRESSING_SOURCE_BIT, 2, instrct->input_a);
-            }
-            add_binary(str, ADDRESSING_DESTINATION_BIT, 2, instrct->output_a); /* group 2 opcodes have only output operand */
-        }
+/*
+ * The words of an instruction, the bits are numbered from the left (bit 0 is the highest bit of the word): 
+ * the first word has the 2 parameters addressing modes of a jump with parameters in bits 0-1 and 2-3, the opcode in bits 4-7, 
+ * the input operand addressing mode in bits 8-9, the output operand addressing mode in bits 10-11 and the encoding type 0 in bits 12-13. 
+ * The other words (maximum 3) have the encoding type in bits 12-13, ENCODING_A for a number or a register, 
+ * ENCODING_E for an extern label and ENCODING_R for a label of the file. Their bits 0-11 are the operand: 
+ * a number in bits 0-11 for ADDRESSING_IMMEDIATE, the IC value of the label in bits 0-11 for ADDRESSING_DIRECT, 
+ * the input register in bits 0-5 and the output register in bits 6-11 for ADDRESSING_REGISTER, 
+ * and when both operands are registers they share 1 word. 
+ * A jump has the output addressing mode ADDRESSING_DIRECT, or ADDRESSING_PARAMATER with parameters, and the word of its label after the first word, 
+ * with parameters the 2 parameters are encoded after the label word as 2 operands.
+*/
+
+/* the first word of an instruction of a given encoder group and addressing modes */
+#define FIRST_WORD_BITS(group, source, destination, opcode) \
+    ((group) == ENCODER_GROUP_ONE ? ((opcode) << 6) | ((source) << 4) | ((destination) << 2) \
+    : (group) == ENCODER_GROUP_TWO ? ((opcode) << 6) | ((destination) << 2) \
+    : (group) == ENCODER_GROUP_THREE ? (opcode) << 6 \
+    : (group) == ENCODER_GROUP_JUMP ? ((opcode) << 6) | (ADDRESSING_DIRECT << 2) \
+    : ((source) << 12) | ((destination) << 10) | ((opcode) << 6) | (ADDRESSING_PARAMATER << 2))
+
+/* the word of a label operand: extern labels values are 0, the second scan rejects addresses above LABEL_MAX_ADDRESS */
+#define LABEL_WORD_BITS(value) ((((value) & INT_MASK) << 2) | ((value) == 0 ? ENCODING_E : ENCODING_R))
+
+/* the word of an operand with a given addressing mode, a register number is shifted by a given register shift */
+#define OPERAND_WORD_BITS(mode, value, register_shift) \
+    ((mode) == ADDRESSING_IMMEDIATE ? ((value) & INT_MASK) << 2 \
+    : (mode) == ADDRESSING_DIRECT ? LABEL_WORD_BITS(value) \
+    : (mode) == ADDRESSING_REGISTER ? ((value) & REGISTER_MASK) << (register_shift) \
+    : 0)
+
+/* defines the words encoder of a given encoder group and addressing modes, the conditions are constant so every encoder keeps only its own steps */
+#define DEFINE_WORDS_ENCODER(group, source, destination) \
+void encode_words_##group##_##source##_##destination(output_buffer *buffer, instruction *instrct, int *IC, int width) { \
+    add_bits_to_buffer(buffer, (*IC)++, width, FIRST_WORD_BITS(group, source, destination, instrct->opcode)); \
+    if((group) == ENCODER_GROUP_JUMP || (group) == ENCODER_GROUP_PARAMETERS) \
+        add_bits_to_buffer(buffer, (*IC)++, width, LABEL_WORD_BITS(instrct->label_p)); \
+    if(((group) == ENCODER_GROUP_ONE || (group) == ENCODER_GROUP_PARAMETERS) && (source) == ADDRESSING_REGISTER && (destination) == ADDRESSING_REGISTER) \
+        add_bits_to_buffer(buffer, (*IC)++, width, ((instrct->input_p & REGISTER_MASK) << (REGISTER_BIT + 2)) | ((instrct->output_p & REGISTER_MASK) << 2)); \
+    else if((group) == ENCODER_GROUP_ONE || (group) == ENCODER_GROUP_PARAMETERS) { \
+        add_bits_to_buffer(buffer, (*IC)++, width, OPERAND_WORD_BITS(source, instrct->input_p, REGISTER_BIT + 2)); \
+        add_bits_to_buffer(buffer, (*IC)++, width, OPERAND_WORD_BITS(destination, instrct->output_p, 2)); \
+    } \
+    if((group) == ENCODER_GROUP_TWO) \
+        add_bits_to_buffer(buffer, (*IC)++, width, OPERAND_WORD_BITS(destination, instrct->output_p, 2)); \
+}
+
+/* defines the words encoders of a given encoder group for every 2 addressing modes */
+#define DEFINE_WORDS_ENCODERS(group) \
+    DEFINE_WORDS_ENCODER(group, 0, 0) DEFINE_WORDS_ENCODER(group, 0, 1) DEFINE_WORDS_ENCODER(group, 0, 2) DEFINE_WORDS_ENCODER(group, 0, 3) \
+    DEFINE_WORDS_ENCODER(group, 1, 0) DEFINE_WORDS_ENCODER(group, 1, 1) DEFINE_WORDS_ENCODER(group, 1, 2) DEFINE_WORDS_ENCODER(group, 1, 3) \
+    DEFINE_WORDS_ENCODER(group, 2, 0) DEFINE_WORDS_ENCODER(group, 2, 1) DEFINE_WORDS_ENCODER(group, 2, 2) DEFINE_WORDS_ENCODER(group, 2, 3) \
+    DEFINE_WORDS_ENCODER(group, 3, 0) DEFINE_WORDS_ENCODER(group, 3, 1) DEFINE_WORDS_ENCODER(group, 3, 2) DEFINE_WORDS_ENCODER(group, 3, 3)
+
+/* the words encoders of a given encoder group in the order of their ENCODER_KEY */
+#define WORDS_ENCODERS_ROW(group) \
+    encode_words_##group##_0_0, encode_words_##group##_0_1, encode_words_##group##_0_2, encode_words_##group##_0_3, \
+    encode_words_##group##_1_0, encode_words_##group##_1_1, encode_words_##group##_1_2, encode_words_##group##_1_3, \
+    encode_words_##group##_2_0, encode_words_##group##_2_1, encode_words_##group##_2_2, encode_words_##group##_2_3, \
+    encode_words_##group##_3_0, encode_words_##group##_3_1, encode_words_##group##_3_2, encode_words_##group##_3_3
+
+DEFINE_WORDS_ENCODERS(0) /* ENCODER_GROUP_ONE */
+DEFINE_WORDS_ENCODERS(1) /* ENCODER_GROUP_TWO */
+DEFINE_WORDS_ENCODERS(2) /* ENCODER_GROUP_THREE */
+DEFINE_WORDS_ENCODERS(3) /* ENCODER_GROUP_JUMP */
+DEFINE_WORDS_ENCODERS(4) /* ENCODER_GROUP_PARAMETERS */
+
+words_encoder words_encoders[WORDS_ENCODERS_COUNT] = { /* indexed by the ENCODER_KEY of every encoder group and addressing modes */
+    WORDS_ENCODERS_ROW(0), WORDS_ENCODERS_ROW(1), WORDS_ENCODERS_ROW(2), WORDS_ENCODERS_ROW(3), WORDS_ENCODERS_ROW(4)
+};
+
+ENCODER_GROUP opcode_encoder_groups[OPCODE_UNKOWN + 1] = { /* the encoder group of every opcode in the order of OPCODE_TYPE */
+    ENCODER_GROUP_ONE, ENCODER_GROUP_ONE, ENCODER_GROUP_ONE, ENCODER_GROUP_ONE, /* mov, cmp, add, sub */
+    ENCODER_GROUP_TWO, ENCODER_GROUP_TWO, ENCODER_GROUP_ONE, ENCODER_GROUP_TWO, /* not, clr, lea, inc */
+    ENCODER_GROUP_TWO, ENCODER_GROUP_JUMP, ENCODER_GROUP_JUMP, ENCODER_GROUP_TWO, /* dec, jmp, bne, red */
+    ENCODER_GROUP_TWO, ENCODER_GROUP_JUMP, ENCODER_GROUP_THREE, ENCODER_GROUP_THREE, /* prn, jsr, rts, stop */
+    ENCODER_GROUP_THREE /* unkown opcodes */
+};
+
+int instruction_get_encoder_key(instruction *instrct) {
+    ENCODER_GROUP group = opcode_encoder_groups[instrct->opcode];
+    group += (group == ENCODER_GROUP_JUMP) * instrct->is_addressing_parameter; /* jump opcodes with parameters have the next group */
+    return ENCODER_KEY(group, instrct->input_a & 3, instrct->output_a & 3); /* ADRESSING_UNKOWN is only used by operands that the group doesn't use */
+}
+
+void add_instruction_to_buffer(output_buffer *buffer, instruction *instrct, int *IC, int width) {
+    words_encoders[instruction_get_encoder_key(instrct)](buffer, instrct, IC, width);
+}
+
+void add_bits_to_buffer(output_buffer *buffer, int IC, int width, int bits) {
+    char line[MAX_COMMAND_LEN]; /* the word number and binary representation are much shorter than a command */
+    int length = width + 1, i;
+    line[0] = '\n';
+    for(i = width; i > 0; i--) { /* the digits from the last one, the word numbers are positive and fit in the width */
+        line[i] = '0' + IC % 10;
+        IC /= 10;
     }
-    add_binary(str, OPCODE_BIT, 4, opcode); /* add the opcode bits to the string */
-    add_binary(str, ENCODING_START_BIT, 2, 0); /* add the encoding bits to the string, the firt machine word encoding bits type is 0 */
-    str[WORD_BIT] = '\0';
-    return str;
+    line[length++] = ' ';
+    for(i = WORD_BIT - 1; i >= 0; i--) /* from the highest bit, as add_binary writes */
+        line[length++] = "./"[(bits >> i) & 1];
+    output_buffer_write(buffer, line, length);
 }
 
-void get_other_words(FILE *file, instruction *instrct, int *IC) {
-    int add_operand = true; /* check if there is another machine word */
-    ENCODING_TYPE encoding_type = ENCODING_A;
-    int i;
-    char *str;
+int instruction_get_words_count(instruction *instrct) {
+    int count = 1; /* the first word */
+    if(instrct == NULL)
+        return 0;
     if(is_opcode_group_three(instrct->opcode))
-        return;
-    str = empty_binary_dot();
-    if(is_opcode_parameter_addresing(instrct->opcode)) { /* if the opcode is parameter addressing opcodes then check if the label is addressing parameters or not */
-        add_binary(str, 0, INT_BIT, instrct->label_p);
-        if(instrct->label_p == 0) /* the labels word index starts from 100 then it will be 0 when the label is extern */
-            encoding_type = ENCODING_E;
-        else
-            encoding_type = ENCODING_R;
-        add_binary(str, ENCODING_START_BIT, 2, encoding_type);
-        str[WORD_BIT] = '\0';
-        fprintf(file, "\n0%i %s", *IC, str);
-        add_operand = instrct->is_addressing_parameter; /* if the label is not addressing parameter then the are no more machine words in the current instruction */
-        (*IC)++; /* append IC by 1 */
+        return count;
+    if(is_opcode_parameter_addresing(instrct->opcode)) { /* the label word and the 2 parameters if they are used */
+        count++;
+        if(instrct->is_addressing_parameter == false)
+            return count;
     }
-    if(add_operand != false && is_opcode_group_three(instrct->opcode) == false) { /* group 3 opcodes don't have more machine words */
-        for(i = 0; i < WORD_BIT; i++) /* resets the unique binary string */
-            str[i] = '.';
-        encoding_type = ENCODING_A;
-        if(is_opcode_group_one(instrct->opcode) || (is_opcode_parameter_addresing(instrct->opcode) && add_operand != false)) { /* group 1 opcodes and addressing parameter instructions have 2 operands\parameters */
-            if(instrct->input_a == ADDRESSING_REGISTER && instrct->output_a == ADDRESSING_REGISTER) {
-                add_binary(str, 0, 6, instrct->input_p);
-                add_binary(str, 6, 6, instrct->output_p);
-                add_operand = false; /* if the operands\parameters addressing type is both ADDRESSING_REGISTER then they will be used in the same machine word */
-            }
-            else {
-                if(instrct->input_a == ADDRESSING_IMMEDIATE || instrct->input_a == ADDRESSING_DIRECT)
-                    add_binary(str, 0, INT_BIT, instrct->input_p);
-                else if(instrct->input_a == ADDRESSING_REGISTER)
-                    add_binary(str, 0, 6, instrct->input_p);
-                if(instrct->input_a == ADDRESSING_DIRECT) {
-                    if(instrct->input_p == 0)
-                        encoding_type = ENCODING_E;
-                    else
-                        encoding_type = ENCODING_R;
-                }
-            }
-            add_binary(str, ENCODING_START_BIT, 2, encoding_type);
-            str[WORD_BIT] = '\0';
-            fprintf(file, "\n0%i %s", *IC, str);
-            (*IC)++; /* append IC by 1 */
-        }
-        if(add_operand != false) { /* if the instruction have only output operand or group 1 opcodes and addressing parameter instructions output operand addressing type is not ADDRESSING_REGISTER */
-            for(i = 0; i < WORD_BIT; i++) /* resets the unique binary string */
-                str[i] = '.';
-            encoding_type = ENCODING_A;
-            if(instrct->output_a == ADDRESSING_IMMEDIATE || instrct->output_a == ADDRESSING_DIRECT)
-                add_binary(str, 0, INT_BIT, instrct->output_p);
-            else if(instrct->output_a == ADDRESSING_REGISTER)
-                add_binary(str, 6, 6, instrct->output_p);
-            if(instrct->output_a == ADDRESSING_DIRECT) {
-                if(instrct->output_p == 0)
-                    encoding_type = ENCODING_E;
-                else
-                    encoding_type = ENCODING_R;
-            }
-            add_binary(str, ENCODING_START_BIT, 2, encoding_type);
-            str[WORD_BIT] = '\0';
-            fprintf(file, "\n0%i %s", *IC, str);
-            (*IC)++; /* append IC by 1 */
-        }
+    else if(is_opcode_group_one(instrct->opcode) == false) /* group 2 opcodes have only output operand */
+        return count + 1;
+    if(instrct->input_a == ADDRESSING_REGISTER && instrct->output_a == ADDRESSING_REGISTER) /* 2 registers are added to the same word */
+        return count + 1;
+    return count + 2;
+}
+
+int get_address_width(int last_IC) {
+    int width = 1;
+    for(; last_IC >= 10; last_IC /= 10)
+        width++;
+    return width > ADDRESS_WIDTH ? width : ADDRESS_WIDTH;
+}
+
+size_t get_words_length(int count, int width) {
+    return (size_t) count * (WORD_BIT + width + 2); /* the new line, the word number, the gap and the word */
+}
+
+void encode_instructions(void *context, char *text, instruction *instrct, int count, int IC, int width) {
+    char *position = text; /* the next character of the text to write */
+    output_buffer *words = create_block_output_buffer(write_text_block, &position);
+    for(; count > 0 && instrct != NULL; count--) {
+        add_instruction_to_buffer(words, instrct, &IC, width);
+        instrct = instrct->next;
     }
+    free_output_buffer(words); /* writes the last block of the words */
 }
 
 void add_binary(char* str, int index, int size, int num) {
@@ -222,14 +286,15 @@ void add_binary(char* str, int index, int size, int num) {
 
 void free_instruction(instruction *head) {
     instruction *root;
-    if(head == NULL) return;
-    root = head->next;
-    free(head);
-    free_instruction(root);   
+    while(head != NULL) { /* the list is freed in a loop because a big file has too many instructions for a recursion */
+        root = head->next;
+        free_counted(head);
+        head = root;
+    }
 }
 
 void free_instruction_list(instruction_list *list) {
     if(list == NULL) return;
     free_instruction(list->head);
-    free(list);
+    free_counted(list);
 }
\ No newline at end of file
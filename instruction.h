@@ -7,6 +7,18 @@
 #define ADDRESSING_DESTINATION_BIT 10 /* the start bit of the addressing destination bits in the machine word */
 #define ENCODING_START_BIT 12 /* the number of bits of a word until the encoding bits */
 #define INT_BIT 12 /* the number of bits that a machine word\machine data contain without the 2 encoding bits */
+#define ADDRESS_WIDTH 4 /* the minimum number of digits of a word number in the object file, padded with zeros */
+#define REGISTER_BIT 6 /* the number of bits of a register number inside an operand word */
+#define WORD_MASK ((1 << WORD_BIT) - 1) /* the bits of a machine word */
+#define INT_MASK ((1 << INT_BIT) - 1) /* the bits of a number inside an operand word */
+#define INT_MAX_VALUE ((1 << (INT_BIT - 1)) - 1) /* the biggest immediate number an operand word can contain in 2's complement */
+#define INT_MIN_VALUE (-(1 << (INT_BIT - 1))) /* the smallest immediate number an operand word can contain in 2's complement */
+#define WORD_MAX_VALUE ((1 << (WORD_BIT - 1)) - 1) /* the biggest integer a data word can contain in 2's complement */
+#define WORD_MIN_VALUE (-(1 << (WORD_BIT - 1))) /* the smallest integer a data word can contain in 2's complement */
+#define LABEL_MAX_ADDRESS INT_MASK /* the biggest label address an operand word can contain */
+#define REGISTER_MASK ((1 << REGISTER_BIT) - 1) /* the bits of a register number inside an operand word */
+#define ENCODER_KEY(group, source, destination) (((group) << 4) | ((source) << 2) | (destination)) /* packs an encoder group and 2 addressing modes into a words encoder index */
+#define WORDS_ENCODERS_COUNT ENCODER_KEY(ENCODER_GROUPS_COUNT, 0, 0) /* the number of words encoders, one for every encoder group and addressing modes */
 
 /**
  * An enum used for determining the addressing type of the operands.
@@ -20,6 +32,30 @@ typedef enum
     ADRESSING_UNKOWN /* operands that are unkown data type use this addressing type (such as initiating an instruction) */
 } ADDRESSING_MODE;
 
+/**
+ * An enum used for identifying the words that an instruction is converted into, every opcode has one group 
+ * except the parameter addressing opcodes that their group depends on the use of parameters.
+*/
+typedef enum ENCODER_GROUP
+{
+    ENCODER_GROUP_ONE, /* the first word, a source operand word and a destination operand word: mov, cmp, add, sub and lea */
+    ENCODER_GROUP_TWO, /* the first word and a destination operand word: not, clr, inc, dec, red and prn */
+    ENCODER_GROUP_THREE, /* only the first word: rts and stop */
+    ENCODER_GROUP_JUMP, /* the first word and a label word: jmp, bne and jsr without parameters */
+    ENCODER_GROUP_PARAMETERS, /* the first word, a label word and 2 parameters words: jmp, bne and jsr with parameters */
+    ENCODER_GROUPS_COUNT /* the number of encoder groups */
+} ENCODER_GROUP;
+
+/**
+ * An enum used for identifying the encoding for every machine word.
+*/
+typedef enum ENCODING_TYPE
+{
+    ENCODING_A, /* used for encoding direct operand words */
+    ENCODING_E, /* used for encoding external labels */
+    ENCODING_R /* used for encoding relocatable words: local labels in a given file that are not extern */
+} ENCODING_TYPE;
+
 /**
  * A data structure that is used for storing system intructions, such as function with parameters and variables 
  * and contains the next instruction the system needs to operate.
@@ -31,6 +67,18 @@ typedef struct instruction_t instruction;
 */
 typedef struct instruction_list instruction_list;
 
+/**
+ * A function that converts a given number of instructions from a given instruction into the object file lines of their words, 
+ * written into a given text that has exactly the room for them, when the first word number is a given IC and the word numbers have a given width.
+*/
+typedef void (*instructions_encoder)(void *context, char *text, instruction *instruct, int count, int IC, int width);
+
+/**
+ * A function that writes every word of a given instruction to a given output buffer and adds the number of its words to a given IC, 
+ * the word numbers are written with a given width. Every words encoder is specialized for one encoder group and addressing modes.
+*/
+typedef void (*words_encoder)(output_buffer *buffer, instruction *instruct, int *IC, int width);
+
 /**
  * Creates an empty instruction and set its opcode type to a given opcode type.
  * @param opcode_type the opcode type to set on the instruction
@@ -53,6 +101,22 @@ instruction_list* create_empty_instruction_list();
 */
 instruction *insert_new_instruction(instruction_list *list, OPCODE_TYPE opcode_type);
 
+/**
+ * Moves every instruction of a given instruction list to the end of another given instruction list, in the same order. 
+ * The other instruction list stays empty.
+ * @param list a given instruction list.
+ * @param other a given instruction list to move the instructions from.
+*/
+void instruction_list_append(instruction_list *list, instruction_list *other);
+
+/**
+ * Adds a copy of every instruction of a given instruction list to the end of another given instruction list, in the same order. 
+ * The other instruction list keeps its instructions.
+ * @param list a given instruction list.
+ * @param other a given instruction list to copy the instructions from.
+*/
+void instruction_list_append_copy(instruction_list *list, instruction_list *other);
+
 /**
  * Returns the opcode type of a given instruction.
  * @param instruct a given instruction.
@@ -123,6 +187,20 @@ int instruction_get_addressing_parameter_status(instruction *instruct);
 */
 void instruction_set_addressing_parameter_status(instruction *instruct, int addressing_parameter_status);
 
+/**
+ * Returns the line of the .am file that a given instruction was declared in.
+ * @param instruct a given instruction.
+ * @returns the line of the instruction, if the instruction equals to NULL then returns 0.
+*/
+int instruction_get_line(instruction *instruct);
+
+/**
+ * Sets the line of the .am file that a given instruction was declared in.
+ * @param instruct a given instruction.
+ * @param line a given line.
+*/
+void instruction_set_line(instruction *instruct, int line);
+
 /**
  * Returns the next instruction after a given instruction.
  * @param instruct a given instruction.
@@ -138,40 +216,69 @@ instruction *get_next_instruction(instruction *instruct);
 instruction *get_first_intruction(instruction_list *list);
 
 /**
- * Returns the unique binary representation of the first word of a given instruction. 
- * The first machine word structre is the following (from left to right): 
- * 0-1 bits inform the first parameter type (only when addressing parameter): can be a number, register or label. 
- * 2-3 bits inform the second parameter type (only when addressing parameter): can be a number, register or label. 
- * 4-7 bits inform the opcode type of the instruction. 
- * 8-9 bits inform the input operand addressing type. 
- * 10-11 bits inform the output operand addressing type. 
- * 12-13 bits inform the endcoding type of the instruction.
+ * Returns the words encoder index of a given instruction: its encoder group and its 2 addressing modes packed with ENCODER_KEY. 
+ * An addressing mode that the group doesn't use does not change the words that the encoder writes.
+ * @param instruct a given instruction.
+ * @returns the index of the words encoder of the instruction.
+*/
+int instruction_get_encoder_key(instruction *instruct);
+
+/**
+ * Writes every word of a given instruction to a given output buffer: the first word and the other words (maximum 3). 
+ * The words are written by the words encoder of the instruction encoder key, so no step depends on the opcode or the addressing modes. 
+ * Also adds the number of words the instruction contains to a given number pointer.
+ * @param buffer a given output buffer to write on the words.
  * @param instruct a given instruction.
- * @returns a string containing the binary representation of the first word of a given instruction. 
-*/
-char *get_first_word(instruction *instruct);
-
-/**
- * Writes all the other words after the first word (maximum 3 words) to a given file from a given instruction. 
- * Also adds the number of words the instruction contains to a given number pointer. 
- * The 2-4 machine words structre is the following for each addressing type (from left to right): 
- * ADDRESSING_IMMEDIATE: 0-11 bits for the number that the operand is equals to. 
- * 
- * ADDRESSING_DIRECT: 0-11 bits fo the IC value that a label contains that the operand is equals to. 
- * 
- * ADDRESSING_PARAMATER: the label operand addressing can only be ADDRESSING_DIRECT and will use it to. 
- * the input and output operand will be used as 2 parameters with the addressing type: ADDRESSING_IMMEDIATE, ADDRESSING_DIRECT or ADDRESSING_REGISTER. 
- * 
- * ADDRESSING_REGISTER: 0-5 bits for the input operand register number, 6-11 bits for the output operand register number. 
- * if both input and output operands are ADDRESSING_REGISTER then add them to the same word. 
- * 
- * The last 12-13 bits of each machine word is used for the encoding type of the machine word.
- * @param file a given file to write on the words.
+ * @param IC a given pointer to the number of the instruction first word.
+ * @param width the number of digits of the word numbers.
+*/
+void add_instruction_to_buffer(output_buffer *buffer, instruction *instruct, int *IC, int width);
+
+/**
+ * Writes a line of the object file to a given output buffer: a new line, the word number padded with zeros to a given width, 
+ * a gap and the unique binary representation of a given word, '0' bits as '.' and '1' bits as '/'.
+ * @param buffer a given output buffer.
+ * @param IC the word number.
+ * @param width the number of digits of the word number, from get_address_width.
+ * @param bits the word, only its lower WORD_BIT bits are written.
+*/
+void add_bits_to_buffer(output_buffer *buffer, int IC, int width, int bits);
+
+/**
+ * Returns the width of the word numbers of an object file: the digits of its last word number, at least ADDRESS_WIDTH. 
+ * Every word number of the file is padded with zeros to this width, so every line of the file has the same length.
+ * @param last_IC the number of the last word of the file.
+ * @returns the number of digits of the word numbers.
+*/
+int get_address_width(int last_IC);
+
+/**
+ * Returns the number of words that a given instruction is converted into: the first word and the other words.
  * @param instruct a given instruction.
- * @param IC a given pointer to an integer.
- *  
+ * @returns the number of words of the instruction, if the instruction equals to NULL then returns 0.
+*/
+int instruction_get_words_count(instruction *instruct);
+
+/**
+ * Returns the number of characters that the object file lines of a given number of words take, when the word numbers have a given width.
+ * Every line is a new line, the word number, 1 gap and the binary representation of the word, so every line has the same length.
+ * @param count the number of words.
+ * @param width the number of digits of the word numbers.
+ * @returns the number of characters of the lines.
+*/
+size_t get_words_length(int count, int width);
+
+/**
+ * Converts a given number of instructions from a given instruction into the object file lines of their words, 
+ * and writes them into a given text that has the room for them (get_words_length of their words count).
+ * @param context not used, so the function can be used as an instructions encoder.
+ * @param text a given text to write the lines into.
+ * @param instruct the first instruction to convert.
+ * @param count the number of instructions to convert.
+ * @param IC the number of the first instruction first word.
+ * @param width the number of digits of the word numbers.
 */
-void get_other_words(FILE *file, instruction *instruct, int *IC);
+void encode_instructions(void *context, char *text, instruction *instruct, int count, int IC, int width);
 
 /**
  * Converts a given integer to a binary representation in a given size 
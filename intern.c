@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+#include "utils.h"
+#include "memory.h"
+
+struct intern_pool_t
+{
+    char **names; /* the name of every id, pointing inside the blocks */
+    int count; /* the number of names inside the pool */
+    int size; /* the number of names the pool can contain before its arrays are doubled */
+    int *buckets; /* the ids of the names by the hash of their name, INTERN_NONE for an empty bucket */
+    char **blocks; /* the blocks of characters that the names are stored in */
+    int blocks_count; /* the number of blocks */
+    int blocks_size; /* the number of blocks the blocks array can contain */
+    size_t block_length; /* the number of characters used in the last block */
+    size_t block_size; /* the number of characters the last block contains */
+};
+
+intern_pool *create_intern_pool() {
+    int i;
+    intern_pool *pool = (intern_pool*) malloc_counted(sizeof(intern_pool), MEMORY_NAMES);
+    pool->count = 0;
+    pool->size = INTERN_START_SIZE;
+    pool->names = (char**) malloc_counted(sizeof(char*) * pool->size, MEMORY_NAMES);
+    pool->buckets = (int*) malloc_counted(sizeof(int) * pool->size * 2, MEMORY_NAMES); /* at most half of the buckets are used */
+    for(i = 0; i < pool->size * 2; i++)
+        pool->buckets[i] = INTERN_NONE;
+    pool->blocks = NULL;
+    pool->blocks_count = 0;
+    pool->blocks_size = 0;
+    pool->block_length = 0;
+    pool->block_size = 0;
+    return pool;
+}
+
+/**
+ * Returns the hash of a given name.
+ * @param name a given name.
+ * @returns the hash of the name.
+*/
+unsigned long intern_hash(char *name) {
+    unsigned long hash = 5381;
+    while(*name != '\0')
+        hash = hash * 33 + (unsigned char) *name++;
+    return hash;
+}
+
+/**
+ * Returns the bucket of a given name inside a given intern pool: 
+ * the bucket that contains the id of the name, or the empty bucket the name will be added to. 
+ * The buckets after the name hash bucket are checked one after the other.
+ * @param pool a given intern pool.
+ * @param name a given name.
+ * @returns the index of the bucket.
+*/
+int intern_pool_bucket(intern_pool *pool, char *name) {
+    int mask = pool->size * 2 - 1;
+    int bucket = (int) (intern_hash(name) & mask);
+    while(pool->buckets[bucket] != INTERN_NONE && strcmp(pool->names[pool->buckets[bucket]], name) != 0)
+        bucket = (bucket + 1) & mask;
+    return bucket;
+}
+
+/**
+ * Copies a given name into the last block of a given intern pool, if the name does not fit then a new block is created.
+ * @param pool a given intern pool.
+ * @param name a given name.
+ * @returns the copy of the name.
+*/
+char *intern_pool_store(intern_pool *pool, char *name) {
+    size_t length = strlen(name) + 1;
+    char *copy;
+    if(pool->block_length + length > pool->block_size) { /* the old blocks are kept because their names are never moved */
+        if(pool->blocks_count == pool->blocks_size) {
+            pool->blocks_size = pool->blocks_size == 0 ? INTERN_START_SIZE : pool->blocks_size * 2;
+            pool->blocks = (char**) realloc_counted(pool->blocks, sizeof(char*) * pool->blocks_size, MEMORY_NAMES);
+        }
+        pool->block_size = length > INTERN_BLOCK_SIZE ? length : INTERN_BLOCK_SIZE;
+        pool->blocks[pool->blocks_count++] = (char*) malloc_counted(pool->block_size, MEMORY_NAMES);
+        pool->block_length = 0;
+    }
+    copy = &pool->blocks[pool->blocks_count - 1][pool->block_length];
+    memcpy(copy, name, length);
+    pool->block_length += length;
+    return copy;
+}
+
+int intern_pool_add(intern_pool *pool, char *name) {
+    int bucket, i;
+    if(pool == NULL || name == NULL)
+        return INTERN_NONE;
+    bucket = intern_pool_bucket(pool, name);
+    if(pool->buckets[bucket] != INTERN_NONE)
+        return pool->buckets[bucket];
+    if(pool->count == pool->size) { /* double the arrays and add every id again to the buckets */
+        pool->size *= 2;
+        pool->names = (char**) realloc_counted(pool->names, sizeof(char*) * pool->size, MEMORY_NAMES);
+        free_counted(pool->buckets);
+        pool->buckets = (int*) malloc_counted(sizeof(int) * pool->size * 2, MEMORY_NAMES);
+        for(i = 0; i < pool->size * 2; i++)
+            pool->buckets[i] = INTERN_NONE;
+        for(i = 0; i < pool->count; i++)
+            pool->buckets[intern_pool_bucket(pool, pool->names[i])] = i;
+        bucket = intern_pool_bucket(pool, name);
+    }
+    pool->names[pool->count] = intern_pool_store(pool, name);
+    pool->buckets[bucket] = pool->count;
+    return pool->count++;
+}
+
+int intern_pool_find(intern_pool *pool, char *name) {
+    if(pool == NULL || name == NULL)
+        return INTERN_NONE;
+    return pool->buckets[intern_pool_bucket(pool, name)];
+}
+
+char *intern_pool_get_name(intern_pool *pool, int id) {
+    if(pool == NULL || id < 0 || id >= pool->count)
+        return NULL;
+    return pool->names[id];
+}
+
+int intern_pool_get_count(intern_pool *pool) {
+    return pool != NULL ? pool->count : 0;
+}
+
+void free_intern_pool(intern_pool *pool) {
+    int i;
+    if(pool == NULL) return;
+    for(i = 0; i < pool->blocks_count; i++)
+        free_counted(pool->blocks[i]);
+    free_counted(pool->blocks);
+    free_counted(pool->buckets);
+    free_counted(pool->names);
+    free_counted(pool);
+}
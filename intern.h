@@ -0,0 +1,59 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#define INTERN_BLOCK_SIZE 4096 /* the number of characters of a block of names, longer names get a block of their own */
+#define INTERN_START_SIZE 64 /* the number of names a new intern pool can contain before its arrays are doubled, must be a power of 2 */
+#define INTERN_NONE -1 /* the id that informs that a name is not inside an intern pool */
+
+/**
+ * A data structure used for storing every distinct name (such as label or macro names) once: 
+ * the names are stored one after the other inside big blocks, and every name gets a small integer id in the order it was added. 
+ * A name is never moved after it was added, so the pointer to a name is the same for every occurrence of it 
+ * and 2 names of the same pool can be compared by their ids or pointers.
+*/
+typedef struct intern_pool_t intern_pool;
+
+/**
+ * Creates an empty intern pool.
+ * @returns the newly created intern pool.
+*/
+intern_pool *create_intern_pool();
+
+/**
+ * Adds a given name to a given intern pool if it is not inside it yet.
+ * @param pool a given intern pool.
+ * @param name a given name.
+ * @returns the id of the name.
+*/
+int intern_pool_add(intern_pool *pool, char *name);
+
+/**
+ * Searches a given name inside a given intern pool.
+ * @param pool a given intern pool.
+ * @param name a given name.
+ * @returns the id of the name, if the name is not inside the pool then returns INTERN_NONE.
+*/
+int intern_pool_find(intern_pool *pool, char *name);
+
+/**
+ * Returns the name of a given id inside a given intern pool, the name is stored until the pool is freed.
+ * @param pool a given intern pool.
+ * @param id a given id.
+ * @returns the name of the id, if the id is not inside the pool then returns NULL.
+*/
+char *intern_pool_get_name(intern_pool *pool, int id);
+
+/**
+ * Returns the number of names inside a given intern pool, the ids of the names are from 0 to this number.
+ * @param pool a given intern pool.
+ * @returns the number of names inside the pool.
+*/
+int intern_pool_get_count(intern_pool *pool);
+
+/**
+ * Free the memory a given intern pool contains from the system memory, including all of its names.
+ * @param pool a given intern pool.
+*/
+void free_intern_pool(intern_pool *pool);
+
+#endif
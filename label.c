@@ -2,231 +2,465 @@
 #include <stdlib.h>
 #include <string.h>
 #include "label.h"
+#include "intern.h"
+#include "memory.h"
 #include "utils.h"
 
 /**
- * A data structure used for storing lines the IC\machine words indexes where a given label occurs on. 
- * This structure is only used for labels with the label type LABEL_EXTERN.
- * Also the structure is linked (linked list).
+ * A data structure used for storing a machine word index where a label with the label type LABEL_EXTERN is used.
 */
-typedef struct extern_word
+typedef struct extern_use
 {
-    int value; /* the current machine word index */
-    struct extern_word *next; /* the next extern word */
-} extern_word;
+    int label_id; /* the id of the extern label */
+    int value; /* the machine word index */
+} extern_use;
 
 /**
- * A data structure that is used for storing externs words with a constant insertion time.
+ * A data structure used for storing a line and a machine word index where a label is used as an operand, used for the cross-reference file.
 */
-typedef struct extern_list
+typedef struct label_use
 {
-    extern_word *head; /* the first extern word in the list */
-    extern_word *root; /* the last extern in the list */
-} extern_list;
+    int label_id; /* the id of the used label */
+    int line; /* the number of the line of the operand */
+    int value; /* the machine word index of the operand */
+} label_use;
 
-struct label_t
+/**
+ * A data structure used for storing the fields of a label that every label search and operand needs, 
+ * the other fields are stored in side tables of the label table by the label id.
+*/
+typedef struct label_record
 {
-    char *name; /* the name of the label */
+    int name_id; /* the id of the label name inside the intern pool of its label table */
+    int IC; /* the machine word index of the label (or the data index before the first scan ends for labels with the label type LABEL_DATA or LABEL_STRING) */
     LABEL_TYPE type; /* the label type of the label */
-    int IC; /* the machine word index of the label, only used for labels with the label type LABEL_ENTRY */
-    int DC; /* the number of data that the label contains, only used for labels with the label type LABEL_DATA of LABEL_STRING */
-    extern_list *externs_list; /* the label extern list, only if the label type of the label is LABEL_EXTERN */
-    unsigned is_entry:1; /* set true\1 if the label is entry (used for the entry file)*/
-    struct label_t *next; /* the next label */
-};
+} label_record;
 
 struct label_table_t
 {
-    label *head; /* the first label in the list */
-    label *root; /* the last label in the list */
+    label_record *labels; /* the labels by their id, in the order they were added */
+    int count; /* the number of labels inside the table */
+    int size; /* the number of labels the arrays can contain before they are doubled */
+    int *data_counts; /* the number of data of every label, only used for labels with the label type LABEL_DATA or LABEL_STRING */
+    unsigned char *entries; /* true\1 for every label that is entry (used for the entry file) */
+    int *lines; /* the number of the line that declared every label (used for the cross-reference file) */
+    intern_pool *names; /* the names of the labels, every name is stored once */
+    int *named; /* the id of the first label of every name id, used for searching labels by name */
+    int named_size; /* the number of name ids the named array can contain */
+    extern_use *externs; /* the uses of the extern labels, in the order they were added */
+    int externs_count; /* the number of extern uses */
+    int externs_size; /* the number of extern uses the array can contain */
+    label_use *uses; /* the uses of the labels as operands, in the order they were added, only added for the cross-reference file */
+    int uses_count; /* the number of label uses */
+    int uses_size; /* the number of label uses the array can contain */
 };
 
+label_table *create_empty_label_table() {
+    int i;
+    label_table *table = (label_table*) malloc_counted(sizeof(label_table), MEMORY_LABELS);
+    table->count = 0;
+    table->size = LABEL_TABLE_START_SIZE;
+    table->labels = (label_record*) malloc_counted(sizeof(label_record) * table->size, MEMORY_LABELS);
+    table->data_counts = (int*) malloc_counted(sizeof(int) * table->size, MEMORY_LABELS);
+    table->entries = (unsigned char*) malloc_counted(table->size, MEMORY_LABELS);
+    table->lines = (int*) malloc_counted(sizeof(int) * table->size, MEMORY_LABELS);
+    table->externs = NULL;
+    table->externs_count = 0;
+    table->externs_size = 0;
+    table->uses = NULL;
+    table->uses_count = 0;
+    table->uses_size = 0;
+    table->names = create_intern_pool();
+    table->named_size = LABEL_TABLE_START_SIZE;
+    table->named = (int*) malloc_counted(sizeof(int) * table->named_size, MEMORY_LABELS);
+    for(i = 0; i < table->named_size; i++)
+        table->named[i] = LABEL_NONE;
+    return table;    
+}
+
 /**
- * Creates an empty extern_word.
- * @returns the newly created extern_word.
+ * Adds a label with a given name, label type, IC and number of data to the end of a given label table and copies the name into the table intern pool. 
+ * The first label of every name is kept by the name id, so searching a label by name only needs to find the name in the pool.
+ * The arrays of the table are doubled when they are full.
+ * @param table a given label table.
+ * @param name a given name.
+ * @param label_type a given label type.
+ * @param IC a given IC.
+ * @param data_count a given number of data.
+ * @returns the id of the new label.
 */
-extern_word *create_empty_extern_word() {
-    extern_word *head = (extern_word*) malloc_and_check(sizeof(extern_word));
-    head->value = 0;
-    head->next = 0;
-    return head;
+int label_table_push(label_table *table, char *name, LABEL_TYPE label_type, int IC, int data_count) {
+    label_record *record;
+    int i, id;
+    if(table->count == table->size) {
+        table->size *= 2;
+        table->labels = (label_record*) realloc_counted(table->labels, sizeof(label_record) * table->size, MEMORY_LABELS);
+        table->data_counts = (int*) realloc_counted(table->data_counts, sizeof(int) * table->size, MEMORY_LABELS);
+        table->entries = (unsigned char*) realloc_counted(table->entries, table->size, MEMORY_LABELS);
+        table->lines = (int*) realloc_counted(table->lines, sizeof(int) * table->size, MEMORY_LABELS);
+    }
+    id = table->count++;
+    record = &table->labels[id];
+    record->name_id = intern_pool_add(table->names, name);
+    record->IC = IC;
+    record->type = label_type;
+    table->data_counts[id] = data_count;
+    table->entries[id] = false;
+    table->lines[id] = 0;
+    if(record->name_id == INTERN_NONE)
+        return id;
+    if(record->name_id >= table->named_size) { /* double the named array until the name id fits */
+        i = table->named_size;
+        while(record->name_id >= table->named_size)
+            table->named_size *= 2;
+        table->named = (int*) realloc_counted(table->named, sizeof(int) * table->named_size, MEMORY_LABELS);
+        for(; i < table->named_size; i++)
+            table->named[i] = LABEL_NONE;
+    }
+    if(table->named[record->name_id] == LABEL_NONE) /* the first occurrence of a name is found first */
+        table->named[record->name_id] = id;
+    return id;
 }
 
 /**
- * Creates an empty extern list.
- * @returns the newly created extern list.
+ * Adds a use of the label with a given id at a given machine word index to the end of the extern uses of a given label table, 
+ * the array is doubled when it is full.
+ * @param table a given label table.
+ * @param label_id a given label id.
+ * @param value a given extern word index.
 */
-extern_list *create_empty_extern_list() {
-    extern_list *list = (extern_list*) malloc_and_check(sizeof(extern_list));
-    list->head = NULL;
-    list->root = NULL;
-    return list;
+void label_table_push_extern_use(label_table *table, int label_id, int value) {
+    if(table->externs_count == table->externs_size) {
+        table->externs_size = table->externs_size == 0 ? LABEL_EXTERNS_START_SIZE : table->externs_size * 2;
+        table->externs = (extern_use*) realloc_counted(table->externs, sizeof(extern_use) * table->externs_size, MEMORY_EXTERNS);
+    }
+    table->externs[table->externs_count].label_id = label_id;
+    table->externs[table->externs_count].value = value;
+    table->externs_count++;
 }
 
-label *create_empty_label() {
-    label *head = (label*) malloc_and_check(sizeof(label));
-    head->name = NULL;
-    head->IC = 0;
-    head->DC = 0;
-    head->type = LABEL_UNKOWN;
-    head->is_entry = false;
-    head->externs_list = NULL;
-    head->next = NULL;
-    return head;
+void label_table_add_extern_use(label_table *table, int id, int value) {
+    if(table == NULL || id < 0 || id >= table->count) return;
+    if(table->labels[id].type != LABEL_EXTERN) return; /* only labels with the label type LABEL_EXTERN can use this function to add a new extern word index */
+    label_table_push_extern_use(table, id, value);
 }
 
-label_table *create_empty_label_table() {
-    label_table *table = (label_table*) malloc_and_check(sizeof(label_table));
-    table->head = NULL;
-    table->root = NULL;
-    return table;    
+/**
+ * Adds a use of the label with a given id at a given line and machine word index to the end of the label uses of a given label table, 
+ * the array is doubled when it is full.
+ * @param table a given label table.
+ * @param label_id a given label id.
+ * @param line a given line number.
+ * @param value a given machine word index.
+*/
+void label_table_push_use(label_table *table, int label_id, int line, int value) {
+    if(table->uses_count == table->uses_size) {
+        table->uses_size = table->uses_size == 0 ? LABEL_USES_START_SIZE : table->uses_size * 2;
+        table->uses = (label_use*) realloc_counted(table->uses, sizeof(label_use) * table->uses_size, MEMORY_REFERENCES);
+    }
+    table->uses[table->uses_count].label_id = label_id;
+    table->uses[table->uses_count].line = line;
+    table->uses[table->uses_count].value = value;
+    table->uses_count++;
+}
+
+void label_table_add_use(label_table *table, int id, int line, int value) {
+    if(table == NULL || id < 0 || id >= table->count) return;
+    label_table_push_use(table, id, line, value);
 }
 
-void label_add_extern_word_index(label *lbl, int value) {
-    extern_list *list;
-    extern_word *root;
-    if(lbl == NULL) return;
-    if(lbl->type != LABEL_EXTERN || lbl->externs_list == NULL) return; /* only labels with the label type LABEL_EXTERN can use this function to add a new extern word index */
-    list = lbl->externs_list;
-    root = create_empty_extern_word();
-    if(list->head == NULL)
-        list->head = root;
-    else if(list->root != NULL)
-        list->root->next = root;
-    root->value = value;
-    list->root = root;
-}
-
-label *add_to_label_table(label_table *table, char *name) {
-    label *root;
-    if(table == NULL) return NULL;
-    root = create_empty_label();
-    if(table->head == NULL)
-        table->head = root;
-    else if(table->root != NULL)
-        table->root->next = root;
-    root->name = name;
-    table->root = root;
-    return root;
-}
-
-label *search_in_label_table(label_table *table, char name[]) {
-    label *head;
-    if(table == NULL) return NULL;
-    head = table->head;
-    while(head != NULL) {
-        if(head->name != NULL && strcmp(head->name, name) == 0)
-            return head;
-        head = head->next;
+int add_to_label_table(label_table *table, char *name) {
+    if(table == NULL) return LABEL_NONE;
+    return label_table_push(table, name, LABEL_UNKOWN, 0, 0);
+}
+
+void label_table_append(label_table *table, label_table *other) {
+    int i;
+    if(table == NULL || other == NULL) return;
+    label_table_append_copy(table, other);
+    other->count = 0;
+    other->externs_count = 0;
+    other->uses_count = 0;
+    for(i = 0; i < other->named_size; i++) /* the moved labels are not in the other table anymore */
+        other->named[i] = LABEL_NONE;
+}
+
+void label_table_append_copy(label_table *table, label_table *other) {
+    int i, first_id;
+    if(table == NULL || other == NULL) return;
+    first_id = table->count; /* the ids of the copied labels start after the labels of the table */
+    for(i = 0; i < other->externs_count; i++)
+        label_table_push_extern_use(table, other->externs[i].label_id + first_id, other->externs[i].value);
+    for(i = 0; i < other->uses_count; i++)
+        label_table_push_use(table, other->uses[i].label_id + first_id, other->uses[i].line, other->uses[i].value);
+    for(i = 0; i < other->count; i++) { /* the names are copied into the table intern pool because the other pool is freed with the other table */
+        label_table_push(table, intern_pool_get_name(other->names, other->labels[i].name_id), other->labels[i].type, other->labels[i].IC, other->data_counts[i]);
+        table->entries[first_id + i] = other->entries[i];
+        table->lines[first_id + i] = other->lines[i];
     }
-    return NULL;
 }
 
-LABEL_TYPE label_get_type(label *lbl) {
-    return lbl != NULL ? lbl->type : LABEL_UNKOWN;
+void label_table_shift_lines(label_table *table, int delta) {
+    int i;
+    if(table == NULL) return;
+    for(i = 0; i < table->count; i++)
+        table->lines[i] += delta;
+    for(i = 0; i < table->uses_count; i++)
+        table->uses[i].line += delta;
+}
+
+int search_in_label_table(label_table *table, char name[]) {
+    int name_id;
+    if(table == NULL) return LABEL_NONE;
+    name_id = intern_pool_find(table->names, name);
+    return name_id != INTERN_NONE ? table->named[name_id] : LABEL_NONE;
+}
+
+int label_table_get_count(label_table *table) {
+    return table != NULL ? table->count : 0;
+}
+
+char *label_get_name(label_table *table, int id) {
+    return table != NULL && id >= 0 && id < table->count ? intern_pool_get_name(table->names, table->labels[id].name_id) : NULL;
+}
+
+LABEL_TYPE label_get_type(label_table *table, int id) {
+    return table != NULL && id >= 0 && id < table->count ? table->labels[id].type : LABEL_UNKOWN;
+}
+
+void label_set_type(label_table *table, int id, LABEL_TYPE label_type) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->labels[id].type = label_type;
+}
+
+int label_get_IC(label_table *table, int id) {
+    return table != NULL && id >= 0 && id < table->count ? table->labels[id].IC : 0;
 }
 
-void label_set_type(label *head, LABEL_TYPE label_type) {
-    head->type = label_type;
-    if(label_type == LABEL_EXTERN) /* if the label type of the label is LABEL_EXTERN then create an empty extern list for the label */
-        head->externs_list = create_empty_extern_list();
-    else
-        head->externs_list = NULL;
+void label_set_IC(label_table *table, int id, int IC) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->labels[id].IC = IC;
 }
 
-int label_get_IC(label *lbl) {
-    return lbl != NULL ? lbl->IC : 0;
+int label_get_DC(label_table *table, int id) {
+    return table != NULL && id >= 0 && id < table->count ? table->data_counts[id] : 0;
 }
 
-void label_set_IC(label *lbl, int IC) {
-    if(lbl != NULL)
-        lbl->IC = IC;
+void label_ascend_DC(label_table *table, int id) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->data_counts[id]++;
 }
 
-int label_get_DC(label *lbl) {
-    return lbl != NULL ? lbl->DC : 0;
+void label_add_DC(label_table *table, int id, int count) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->data_counts[id] += count;
 }
 
-void label_ascend_DC(label *lbl) {
-    if(lbl != NULL)
-        lbl->DC++;
+void label_set_line(label_table *table, int id, int line) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->lines[id] = line;
 }
 
-void label_set_entry_status(label *lbl, int status) {
-    if(lbl != NULL)
-        lbl->is_entry = status;
+int label_get_line(label_table *table, int id) {
+    return table != NULL && id >= 0 && id < table->count ? table->lines[id] : 0;
 }
 
-label *get_next_label(label *lbl) {
-    return lbl != NULL ? lbl->next : NULL;
+void label_set_entry_status(label_table *table, int id, int status) {
+    if(table != NULL && id >= 0 && id < table->count)
+        table->entries[id] = status != false;
 }
 
+void free_label_table(label_table *table) {
+    if(table == NULL) return;
+    free_counted(table->labels);
+    free_counted(table->data_counts);
+    free_counted(table->entries);
+    free_counted(table->lines);
+    free_counted(table->named);
+    free_intern_pool(table->names);
+    free_counted(table->externs);
+    free_counted(table->uses);
+    free_counted(table);
+}
+
+int label_table_has_extern_uses(label_table *table) {
+    return table != NULL && table->externs_count > 0;
+}
+
+void add_extern_uses_to_buffer(output_buffer *output, label_table *table, int sorted_by_address) {
+    int *starts; /* the index of the first use of every label in the sorted uses, counted first */
+    extern_use *sorted; /* the uses grouped by their label id */
+    extern_use *uses = table->externs;
+    char line[MAX_COMMAND_LEN]; /* the word number is much shorter than a command */
+    int i;
+    sorted = NULL;
+    if(sorted_by_address == false) { /* a stable counting sort by the label id keeps the uses of every label in the order they were added */
+        starts = (int*) malloc_counted(sizeof(int) * (table->count + 1), MEMORY_EXTERNS);
+        for(i = 0; i <= table->count; i++)
+            starts[i] = 0;
+        for(i = 0; i < table->externs_count; i++)
+            starts[uses[i].label_id + 1]++;
+        for(i = 0; i < table->count; i++)
+            starts[i + 1] += starts[i];
+        sorted = (extern_use*) malloc_counted(sizeof(extern_use) * (table->externs_count + 1), MEMORY_EXTERNS);
+        for(i = 0; i < table->externs_count; i++)
+            sorted[starts[uses[i].label_id]++] = uses[i];
+        free_counted(starts);
+        uses = sorted;
+    }
+    for(i = 0; i < table->externs_count; i++) { /* adds the label name and word index of every use into the extern file */
+        if(i > 0)
+            output_buffer_puts(output, "\n");
+        output_buffer_puts(output, label_get_name(table, uses[i].label_id));
+        sprintf(line, " %i", uses[i].value);
+        output_buffer_puts(output, line);
+    }
+    free_counted(sorted);
+}
+
+void add_entries_to_buffer(output_buffer *output, label_table *table) {
+    char line[MAX_COMMAND_LEN]; /* the label value is much shorter than a command */
+    int id, line_num = 0;
+    for(id = 0; id < table->count; id++) {
+        if(table->entries[id] != false) { /* add the label name and data counter only if the label was marked as entry */
+            if(line_num > 0)
+                output_buffer_puts(output, "\n");
+            output_buffer_puts(output, label_get_name(table, id));
+            sprintf(line, " %i", table->labels[id].IC);
+            output_buffer_puts(output, line);
+            line_num++;
+        }
+    }
+}
+
+/**
+ * A data structure used for sorting the labels of a label table by their IC value.
+*/
+typedef struct symbol_order
+{
+    int IC; /* the IC value of the label */
+    int id; /* the id of the label, orders the labels with the same IC value */
+} symbol_order;
+
 /**
- * Returns the first extern_word of an extern_word list.
- * @param list a given extern_word list.
- * @returns the first extern_word of the extern_word list.
+ * Compares 2 given symbol orders by their IC value and then by their label id, used by qsort.
+ * @param first a given symbol order.
+ * @param second a given symbol order.
+ * @returns a negative number if the first order is before the second, a positive number if it is after it, returns 0 otherwise.
 */
-extern_word *get_first_extern_word(extern_list *list) {
-    return list != NULL ? list->head : NULL;
+int compare_symbol_orders(const void *first, const void *second) {
+    const symbol_order *a = (const symbol_order*) first, *b = (const symbol_order*) second;
+    if(a->IC != b->IC)
+        return a->IC < b->IC ? -1 : 1;
+    return a->id < b->id ? -1 : (a->id > b->id);
 }
 
-label *get_first_label(label_table *table) {
-    return table != NULL ? table->head : NULL;
+/**
+ * Returns the number of decimal digits of a given non negative integer, or a given minimum if it is bigger.
+ * @param value a given non negative integer.
+ * @param minimum the minimum number of digits.
+ * @returns the number of digits.
+*/
+int get_digits_count(int value, int minimum) {
+    int digits = 1;
+    for(; value >= 10; value /= 10)
+        digits++;
+    return digits > minimum ? digits : minimum;
 }
 
 /**
- * Free the memory a given extern list contains from the system memory.
- * @param list a given extern list.
+ * Returns the type name of a given label type in a symbol line, every label type has a name.
+ * @param label_type a given label type.
+ * @returns "code" for a code label, "none" for a label without a statement, otherwise the name of the statement of the label type.
 */
-void free_extern_list(extern_list *list) {
-    extern_word *head, *next;
-    if(list == NULL) return;
-    next = list->head;
-    while(next != NULL) {
-        head = next;
-        next = next->next;
-        free(head);
-    }
-    free(list);
+char *get_symbol_type_name(LABEL_TYPE label_type) {
+    if(label_type == LABEL_CODE)
+        return "code";
+    if(get_label_type_name(label_type) == NULL)
+        return "none";
+    return get_label_type_name(label_type);
 }
 
-void free_label(label *head) {
-    label *root;
-    if(head == NULL) return;
-    root = head->next;
-    free(head->name);
-    free_extern_list(head->externs_list);
-    free(head);
-    free_label(root);
+void add_symbols_to_buffer(output_buffer *output, label_table *table) {
+    char line[MAX_COMMAND_LEN]; /* a symbol line is shorter than a command */
+    symbol_order *orders = (symbol_order*) malloc_counted(sizeof(symbol_order) * (table->count + 1), MEMORY_LABELS);
+    LABEL_TYPE type;
+    int i, id, length, address_width, length_width, max_length = 0;
+    for(i = 0; i < table->count; i++) {
+        type = table->labels[i].type;
+        orders[i].IC = type != LABEL_EXTERN ? table->labels[i].IC : 0;
+        orders[i].id = i;
+        if((type == LABEL_DATA || type == LABEL_STRING) && table->data_counts[i] > max_length)
+            max_length = table->data_counts[i];
+    }
+    qsort(orders, table->count, sizeof(symbol_order), compare_symbol_orders);
+    address_width = get_digits_count(table->count > 0 ? orders[table->count - 1].IC : 0, SYMBOL_ADDRESS_WIDTH); /* every line has the same length */
+    length_width = get_digits_count(max_length, SYMBOL_LENGTH_WIDTH);
+    for(i = 0; i < table->count; i++) {
+        id = orders[i].id;
+        type = table->labels[id].type;
+        length = type == LABEL_DATA || type == LABEL_STRING ? table->data_counts[id] : 0;
+        sprintf(line, "%0*i %-*s %*i %c %-*s\n", address_width, orders[i].IC, SYMBOL_TYPE_WIDTH, get_symbol_type_name(type),
+            length_width, length, table->entries[id] != false ? 'e' : '-', MAX_LABEL_NAME, label_get_name(table, id));
+        output_buffer_puts(output, line);
+    }
+    free_counted(orders);
 }
 
-void free_label_table(label_table *table) {
-    if(table == NULL) return;
-    free_label(table->head);
-    free(table);
-}
-
-void add_extern_list_to_file(FILE *file, label *lbl, int *line_num) {
-    extern_word *extrn; /* the extern list of the current label (if label is extern) */
-    if(lbl->type == LABEL_EXTERN) { /* only if the label type is extern then add it's word counters into the extern file */
-        extrn = get_first_extern_word(lbl->externs_list);
-        while(extrn != NULL) {
-            if(*line_num > 0)
-                fprintf(file, "\n");            
-            fprintf(file, "%s %i", lbl->name, extrn->value); /* adds the current label name and IC counter into the extern file */
-            extrn = extrn->next;
-            (*line_num)++;
-        }
-    }   
+/**
+ * A data structure used for sorting the labels of a label table by their name.
+*/
+typedef struct reference_order
+{
+    char *name; /* the name of the label */
+    int id; /* the id of the label */
+} reference_order;
+
+/**
+ * Compares 2 given reference orders by their name, used by qsort. The names of a label table are unique.
+ * @param first a given reference order.
+ * @param second a given reference order.
+ * @returns a negative number if the first order is before the second, a positive number if it is after it, returns 0 otherwise.
+*/
+int compare_reference_orders(const void *first, const void *second) {
+    return strcmp(((const reference_order*) first)->name, ((const reference_order*) second)->name);
 }
 
-void add_entry_to_file(FILE *file, label *lbl, int *line_num) {
-    if(lbl->is_entry != false) { /* add the label name and data counter only if the label was marked as entry */
-        if(*line_num > 0)
-            fprintf(file, "\n");
-        fprintf(file, "%s %i", lbl->name, lbl->IC);
-        (*line_num)++;
+void add_references_to_buffer(output_buffer *output, label_table *table) {
+    char line[MAX_COMMAND_LEN]; /* a label line number or use is much shorter than a command */
+    int *starts; /* the index of the first use of every label in the sorted uses, counted first */
+    reference_order *orders = (reference_order*) malloc_counted(sizeof(reference_order) * (table->count + 1), MEMORY_REFERENCES); /* the labels sorted by their names */
+    label_use *sorted = (label_use*) malloc_counted(sizeof(label_use) * (table->uses_count + 1), MEMORY_REFERENCES); /* the uses grouped by their label id */
+    int i, id, use;
+    starts = (int*) malloc_counted(sizeof(int) * (table->count + 1), MEMORY_REFERENCES);
+    for(i = 0; i <= table->count; i++)
+        starts[i] = 0;
+    for(i = 0; i < table->uses_count; i++) /* a stable counting sort by the label id keeps the uses of every label in the order of the lines */
+        starts[table->uses[i].label_id + 1]++;
+    for(i = 0; i < table->count; i++)
+        starts[i + 1] += starts[i];
+    for(i = 0; i < table->uses_count; i++)
+        sorted[starts[table->uses[i].label_id]++] = table->uses[i];
+    for(i = 0; i < table->count; i++) {
+        orders[i].name = label_get_name(table, i);
+        orders[i].id = i;
+    }
+    qsort(orders, table->count, sizeof(reference_order), compare_reference_orders);
+    for(i = 0; i < table->count; i++) {
+        id = orders[i].id;
+        use = id > 0 ? starts[id - 1] : 0; /* after the sort every start is the end of the uses of its label */
+        output_buffer_puts(output, label_get_name(table, id));
+        sprintf(line, " %i %i", table->lines[id], starts[id] - use);
+        output_buffer_puts(output, line);
+        for(; use < starts[id]; use++) {
+            sprintf(line, " %i:%i", sorted[use].line, sorted[use].value);
+            output_buffer_puts(output, line);
+        }
+        output_buffer_puts(output, "\n");
     }
+    free_counted(starts);
+    free_counted(sorted);
+    free_counted(orders);
 }
 
 LABEL_TYPE get_label_type(char str[]) {
@@ -1,7 +1,16 @@
 #ifndef LABEL_H
 #define LABEL_H
 
+#include "utils.h"
+
 #define MAX_LABEL_NAME 30 /* the maximum length of a label name is 30 */
+#define LABEL_TABLE_START_SIZE 64 /* the number of labels and name ids a new label table can contain before its arrays are doubled */
+#define LABEL_EXTERNS_START_SIZE 64 /* the number of extern uses a label table can contain before its array is doubled */
+#define LABEL_USES_START_SIZE 256 /* the number of label uses a label table can contain before its array is doubled */
+#define LABEL_NONE -1 /* the id that informs that a label does not exist */
+#define SYMBOL_ADDRESS_WIDTH 4 /* the minimum number of digits of the address of a symbol line, padded with zeros */
+#define SYMBOL_TYPE_WIDTH 7 /* the number of characters of the type of a symbol line, the length of ".string" and ".extern" */
+#define SYMBOL_LENGTH_WIDTH 4 /* the minimum number of characters of the data length of a symbol line */
 
 /**
  * An enum used for determining the label type of the labels.
@@ -18,21 +27,11 @@ typedef enum LABEL_TYPE
 
 /**
  * A data structure that is used for storing system labels, that contains the name, label type and value of each label. 
- * Also the structure is linked (linked list).
-*/
-typedef struct  label_t label;
-
-/**
- * A data structure that is used for storing linked labels that contains the first label and last label in line.
+ * The labels are stored in one dense array of small records (the name id, label type and IC) and are identified by their index (the label id), 
+ * the fields that are used less often (the number of data, the entry status and the extern uses) are stored in side tables by the label id.
 */
 typedef struct label_table_t label_table;
 
-/**
- * Creates an empty label and sets it's label type to LABEL_UNKOWN.
- * @returns the newly created label.
-*/
-label *create_empty_label();
-
 /**
  * Creates an empty label table.
  * @returns the newly created label table.
@@ -40,99 +39,158 @@ label *create_empty_label();
 label_table *create_empty_label_table();
 
 /**
- * Adds to a label an extern word index only if the label type is LABEL_EXTERN.
- * @param lbl a given label.
+ * Adds to a given label table a use of the label with a given id at an extern word index only if the label type is LABEL_EXTERN. 
+ * The uses of all the labels are stored in one array of label ids and word indexes, in the order they were added.
+ * @param table a given label table.
+ * @param id a given label id.
  * @param value a given extern word index.
 */
-void label_add_extern_word_index(label *lbl, int value);
+void label_table_add_extern_use(label_table *table, int id, int value);
 
 /**
- * Creates an empty label and sets its name to a given name.
- * After that inserts the newly created label to the end of a given label table and returns the new label.
+ * Adds to a given label table a use of the label with a given id as an operand at a given line and machine word index, 
+ * the uses of all the labels are stored in one array in the order they were added and are written to the cross-reference file.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @param line a given line number.
+ * @param value a given machine word index.
+*/
+void label_table_add_use(label_table *table, int id, int line, int value);
+
+/**
+ * Adds a label with a given name and the label type LABEL_UNKOWN to the end of a given label table, 
+ * the name is copied into the intern pool of the label table once for all its labels.
  * @param table a given label table.
  * @param name a given name.
- * @returns the newly created label, returns NULL if failed to create.
+ * @returns the id of the new label, returns LABEL_NONE if failed to create.
+*/
+int add_to_label_table(label_table *table, char *name);
+
+/**
+ * Adds a given number to the declaration lines of the labels and to the lines of the label uses of a given label table.
+ * @param table a given label table.
+ * @param delta the number to add to every line number.
+*/
+void label_table_shift_lines(label_table *table, int delta);
+
+/**
+ * Moves every label and extern use of a given label table to the end of another given label table, in the same order. 
+ * The other label table stays empty.
+ * @param table a given label table.
+ * @param other a given label table to move the labels from.
 */
-label *add_to_label_table(label_table *table, char *name);
+void label_table_append(label_table *table, label_table *other);
+
+/**
+ * Copies every label and extern use of a given label table to the end of another given label table, in the same order. 
+ * The other label table keeps its labels.
+ * @param table a given label table.
+ * @param other a given label table to copy the labels from.
+*/
+void label_table_append_copy(label_table *table, label_table *other);
 
 /**
  * Searches a given label table to find a label that its name equals to a given name. 
  * If this label exists then return the first occurrence in the label table.
  * @param table a given label table.
  * @param name a given name.
- * @returns the label that its name equals to a given name, if not exists then returns NULL.
+ * @returns the id of the label that its name equals to a given name, if not exists then returns LABEL_NONE.
 */
-label *search_in_label_table(label_table *table, char name[]);
+int search_in_label_table(label_table *table, char name[]);
+
+/**
+ * Returns the number of labels inside a given label table, the ids of the labels are from 0 to this number in the order they were added.
+ * @param table a given label table.
+ * @returns the number of labels inside the table.
+*/
+int label_table_get_count(label_table *table);
+
+/**
+ * Returns the name of a given label.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @returns the name of the label, if the label does not exist then returns NULL.
+*/
+char *label_get_name(label_table *table, int id);
 
 /**
  * Returns the label type of a given label.
- * @param lbl a given label.
- * @returns the label type of the label, if the label equals to NULL then returns LABEL_UNKOWN.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @returns the label type of the label, if the label does not exist then returns LABEL_UNKOWN.
 */
-LABEL_TYPE label_get_type(label *lbl);
+LABEL_TYPE label_get_type(label_table *table, int id);
 
 /**
- * Sets the label type of a given label to a given label type and 
- * checks if the label type is LABEL_EXTERN. If yes then creates an extern list for the label, 
- * otherwise sets the label extern list to NULL.
- * @param head a given label.
+ * Sets the label type of a given label to a given label type.
+ * @param table a given label table.
+ * @param id a given label id.
  * @param label_type a given label type.
 */
-void label_set_type(label *head, LABEL_TYPE label_type);
+void label_set_type(label_table *table, int id, LABEL_TYPE label_type);
 
 /**
  * Returns the label IC value.
- * @param lbl a given label.
- * @returns the label IC value, if the label equals to NULL then returns 0.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @returns the label IC value, if the label does not exist then returns 0.
 */
-int label_get_IC(label *lbl);
+int label_get_IC(label_table *table, int id);
 
 /**
  * Sets the label IC value to a given integer.
- * @param lbl a given label.
+ * @param table a given label table.
+ * @param id a given label id.
  * @param IC the label IC value.
 */
-void label_set_IC(label *lbl, int IC);
+void label_set_IC(label_table *table, int id, int IC);
 
 /**
  * Returns the label DC value.
- * @param lbl a given label.
- * @returns the label DC value, if the label equals to NULL then returns 0.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @returns the label DC value, if the label does not exist then returns 0.
 */
-int label_get_DC(label *lbl);
+int label_get_DC(label_table *table, int id);
 
 /**
  * Ascend a given label DC value by 1;
- * @param lbl a given label.
+ * @param table a given label table.
+ * @param id a given label id.
 */
-void label_ascend_DC(label *lbl);
+void label_ascend_DC(label_table *table, int id);
 
 /**
- * Sets the entry status of a given label: if true\1 then the label will be used in the entry file.
- * @param lbl a given label.
- * @param status 
+ * Adds a given number to a given label DC value, used when the data of a statement is added at once.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @param count the number of data to add.
 */
-void label_set_entry_status(label *lbl, int status);
+void label_add_DC(label_table *table, int id, int count);
 
 /**
- * Returns the next label after a given label.
- * @param lbl a given label.
- * @returns the next label to use after a given label, if lbl is NULL then returns NULL.
+ * Sets the number of the line that declared a given label.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @param line a given line number.
 */
-label *get_next_label(label *lbl);
+void label_set_line(label_table *table, int id, int line);
 
 /**
- * Returns the first label of a label table.
+ * Returns the number of the line that declared a given label.
  * @param table a given label table.
- * @returns the first label of the label table.
+ * @param id a given label id.
+ * @returns the line number, returns 0 if the label does not exist.
 */
-label *get_first_label(label_table *table);
+int label_get_line(label_table *table, int id);
 
 /**
- * Free the memory a given label contains from the system memory.
- * @param head a given label.
+ * Sets the entry status of a given label: if true\1 then the label will be used in the entry file.
+ * @param table a given label table.
+ * @param id a given label id.
+ * @param status 
 */
-void free_label(label *head);
+void label_set_entry_status(label_table *table, int id, int status);
 
 /**
  * Free the memory a given label table contains from the system memory.
@@ -141,25 +199,53 @@ void free_label(label *head);
 void free_label_table(label_table *table);
 
 /**
- * Checks if the label type of a given label is LABEL_EXTERN, and if true 
- * then adds its extern list to a given file in the following way: 
- * for every extern member create a new line with the label name, 1 gap and the extern word number.
- * for every extern that the function writes to the file append line_num by 1.
- * @param file a given file to write extern list on.
- * @param lbl a given label.
- * @param line_num a given line number.
+ * Checks if extern labels were used in a given label table.
+ * @param table a given label table.
+ * @returns true\1 if the table has extern uses, returns false\0 otherwise.
+*/
+int label_table_has_extern_uses(label_table *table);
+
+/**
+ * Adds the extern uses of a given label table to a given output buffer in the following way: 
+ * for every use create a line with the label name, 1 gap and the extern word number, the lines are separated by new lines. 
+ * By default the uses are grouped by their label in the label table order, with a stable counting sort by the label id, 
+ * so the uses of every label stay in the order they were added. 
+ * Otherwise the uses are written in the order they were added, that is the order of their word numbers.
+ * @param output a given output buffer to write the extern uses on.
+ * @param table a given label table.
+ * @param sorted_by_address if true\1 then the uses are written by their word numbers, otherwise they are grouped by their label.
+*/
+void add_extern_uses_to_buffer(output_buffer *output, label_table *table, int sorted_by_address);
+
+/**
+ * Adds every label of a given label table that its entry status is true\1 to a given output buffer: 
+ * for every entry label create a line with the label name, 1 gap and the label IC value, the lines are separated by new lines.
+ * @param output a given output buffer to write entries on.
+ * @param table a given label table.
 */
-void add_extern_list_to_file(FILE *file, label *lbl, int *line_num);
+void add_entries_to_buffer(output_buffer *output, label_table *table);
 
 /**
- * Checks if a given label entry status is true\1 
- * and if so then adds the label name, 1 gap and the label IC value to a given file.
- * if the file is entry then append line_num by 1.
- * @param file a given file to write entry on.
- * @param lbl a given label.
- * @param line_num a given line number.
+ * Adds every label of a given label table to a given output buffer sorted by the label IC value, labels with the same value stay in the table order. 
+ * Every label is a line with the same length, so the line of index k starts at k times the length of the first line and the lines can be binary searched: 
+ * the IC value padded with zeros, the type (code, .data, .string, .extern or none for a label without a statement) padded to SYMBOL_TYPE_WIDTH, 
+ * the data length padded with spaces, 'e' for entry labels or '-' otherwise, and the name padded to MAX_LABEL_NAME, separated by 1 gap. 
+ * The IC values and data lengths are padded to the digits of the biggest of them, at least SYMBOL_ADDRESS_WIDTH and SYMBOL_LENGTH_WIDTH. 
+ * Extern labels have the value 0 and code and extern labels have the data length 0.
+ * @param output a given output buffer to write the symbols on.
+ * @param table a given label table.
+*/
+void add_symbols_to_buffer(output_buffer *output, label_table *table);
+
+/**
+ * Adds the cross-reference of every label of a given label table to a given output buffer, sorted by the label names: 
+ * for every label create a line with the label name, the line that declared it, the number of its uses as an operand 
+ * and then every use as the line number and machine word number separated by ':', all separated by 1 gap. 
+ * The uses are grouped by their label with a stable counting sort, so the uses of every label stay in the order of the lines.
+ * @param output a given output buffer to write the cross-reference on.
+ * @param table a given label table.
 */
-void add_entry_to_file(FILE *file, label *lbl, int *line_num);
+void add_references_to_buffer(output_buffer *output, label_table *table);
 
 /**
  * Returns the label type to identify a given string.
@@ -1,16 +1,95 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include "assembler.h"
+#include "options.h"
+#include "server.h"
+#include "watch.h"
+#include "simulator.h"
+#include "memory.h"
 
 int main(int argc, char **argv) {
     machine *machine = initialize_machine();
+    macro_table *prelude = NULL; /* the macros that every file can use, only loaded with the option --prelude */
+    include_cache *includes = create_include_cache(); /* every included file is expanded once for all the files */
+    simulator *sim = NULL; /* the simulator to run the assembled files on, only created with the option --simulate */
+    long total_steps = 0; /* the number of instructions simulated over all the files */
+    double total_seconds = 0; /* the processor time of the simulations over all the files */
+    assembler_options options; /* the options given before the file names */
+    int assembled, used;
     int files = 1;
+    int status = 0; /* the exit status of the program, 1 if a file had errors or the prelude could not be loaded so scripts can check the result */
+    set_default_options(&options);
+    while(argc > files && (used = parse_option(&options, argc, argv, files)) > 0) /* options must be given before the file names */
+        files += used;
+    machine_set_include_cache(machine, includes);
+    apply_options(machine, &options);
+    if(options.prelude != NULL) { /* the prelude is loaded once and shared by every file */
+        prelude = load_macro_prelude(options.prelude, machine_get_diagnostics(machine));
+        if(diagnostics_get_count(machine_get_diagnostics(machine)) > 0)
+            diagnostics_flush(machine_get_diagnostics(machine), stdout);
+        if(prelude == NULL) {
+            free_machine(machine);
+            free_include_cache(includes);
+            return 1;
+        }
+        machine_set_prelude(machine, prelude);
+    }
+    if(options.server != false) { /* the files are received as requests from the standard input */
+        run_server(machine, &options, stdin);
+        free_machine(machine);
+        free_macro_table(prelude);
+        free_include_cache(includes);
+        return 0;
+    }
+    if(options.watch != false) { /* the files are assembled again every time they change, until the program is stopped */
+        if(argc > files)
+            run_watch(machine, &prelude, options.prelude, &argv[files], argc - files);
+        else {
+            printf("Error: the option --watch requires file names\n");
+            status = 1;
+        }
+        free_machine(machine);
+        free_macro_table(prelude);
+        free_include_cache(includes);
+        return status;
+    }
+    if(options.simulate != false)
+        sim = create_simulator();
     while(argc > files) {
-        reset_machine(machine);
-        full_assembler(machine, argv[files]);
-	    printf("\n\n");
+        assembled = assemble_with_options(machine, &options, argv[files]);
+        diagnostics_flush(machine_get_diagnostics(machine), stdout); /* the errors of every file are written at once */
+        if(options.memory_report != false) /* the report is written to the standard error so it is not mixed with the errors formats */
+            memory_report(stderr, argv[files], false);
+        if(assembled != false && sim != NULL && simulator_load(sim, argv[files]) != false) {
+            simulator_run(sim, SIM_MAX_STEPS);
+            total_steps += simulator_get_steps(sim);
+            total_seconds += simulator_get_seconds(sim);
+            printf("Simulated %s: %li instructions in %.3f seconds", argv[files], simulator_get_steps(sim), simulator_get_seconds(sim));
+            if(simulator_get_seconds(sim) > 0)
+                printf(" (%.0f instructions per second)", simulator_get_steps(sim) / simulator_get_seconds(sim));
+            printf("\n");
+        }
+        if(options.format == DIAGNOSTICS_TEXT) /* the machine readable formats contain only their own lines */
+            printf("\n\n");
         files++;
+        if(assembled == false)
+            status = 1;
+        if(assembled == false && options.fail_fast != false) /* the files after the first file with errors are not assembled */
+            break;
+    }
+    if(sim != NULL) {
+        printf("Simulated %li instructions in %.3f seconds", total_steps, total_seconds);
+        if(total_seconds > 0)
+            printf(" (%.0f instructions per second)", total_steps / total_seconds);
+        printf("\n");
+        free_simulator(sim);
     }
-    return 0;
+    if(options.memory_report != false)
+        memory_report(stderr, "all files", true);
+    free_machine(machine);
+    free_macro_table(prelude);
+    free_include_cache(includes);
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#define _XOPEN_SOURCE 500 /* getrusage for the peak resident set size */
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "memory.h"
+#include "utils.h"
+
+/**
+ * A data structure used for the header before every counted allocation,
+ * it is a union with the types that have the strictest alignment so the memory after it keeps the alignment of malloc.
+*/
+typedef union memory_header
+{
+    struct
+    {
+        size_t size; /* the number of bytes after the header */
+        MEMORY_CATEGORY category; /* the category of the memory, MEMORY_CATEGORIES_COUNT if it is not counted */
+    } info;
+    long alignment_long; /* unused, only aligns the header */
+    double alignment_double; /* unused, only aligns the header */
+    void *alignment_pointer; /* unused, only aligns the header */
+} memory_header;
+
+/**
+ * A data structure used for the memory usage of one category or of all of them.
+*/
+typedef struct memory_usage
+{
+    size_t bytes; /* the number of bytes that are allocated now */
+    size_t objects; /* the number of objects that are allocated now */
+    size_t peak; /* the maximum number of bytes since the start of the current file */
+    size_t batch_peak; /* the maximum number of bytes since the start of the program */
+} memory_usage;
+
+static int accounting = false; /* true\1 while the allocations are counted */
+static memory_usage usages[MEMORY_CATEGORIES_COUNT + 1]; /* the usage of every category, and the usage of all of them at the end */
+static pthread_mutex_t usages_lock = PTHREAD_MUTEX_INITIALIZER; /* the chunks of a file are allocated on several threads */
+
+/**
+ * Adds a given number of bytes and objects to the usage of a given category and of all the categories, and updates their peaks.
+ * @param category a counted category.
+ * @param bytes the number of bytes to add, negative to remove bytes.
+ * @param objects the number of objects to add, negative to remove objects.
+*/
+void memory_count(MEMORY_CATEGORY category, long bytes, int objects) {
+    memory_usage *usage[2];
+    int i;
+    usage[0] = &usages[category];
+    usage[1] = &usages[MEMORY_CATEGORIES_COUNT];
+    pthread_mutex_lock(&usages_lock);
+    for(i = 0; i < 2; i++) {
+        usage[i]->bytes += bytes;
+        usage[i]->objects += objects;
+        if(usage[i]->bytes > usage[i]->peak)
+            usage[i]->peak = usage[i]->bytes;
+        if(usage[i]->bytes > usage[i]->batch_peak)
+            usage[i]->batch_peak = usage[i]->bytes;
+    }
+    pthread_mutex_unlock(&usages_lock);
+}
+
+void memory_set_accounting(int status) {
+    accounting = status;
+}
+
+void *malloc_counted(size_t size, MEMORY_CATEGORY category) {
+    memory_header *header = (memory_header*) malloc_and_check(sizeof(memory_header) + size);
+    header->info.size = size;
+    header->info.category = accounting != false ? category : MEMORY_CATEGORIES_COUNT;
+    if(header->info.category != MEMORY_CATEGORIES_COUNT)
+        memory_count(category, size, 1);
+    return header + 1;
+}
+
+void *realloc_counted(void *ptr, size_t size, MEMORY_CATEGORY category) {
+    memory_header *header;
+    if(ptr == NULL)
+        return malloc_counted(size, category);
+    header = (memory_header*) realloc_and_check((memory_header*) ptr - 1, sizeof(memory_header) + size);
+    if(header->info.category != MEMORY_CATEGORIES_COUNT)
+        memory_count(header->info.category, (long) size - (long) header->info.size, 0);
+    header->info.size = size;
+    return header + 1;
+}
+
+void free_counted(void *ptr) {
+    memory_header *header;
+    if(ptr == NULL)
+        return;
+    header = (memory_header*) ptr - 1;
+    if(header->info.category != MEMORY_CATEGORIES_COUNT)
+        memory_count(header->info.category, -(long) header->info.size, -1);
+    free(header);
+}
+
+void memory_start_file() {
+    int i;
+    pthread_mutex_lock(&usages_lock);
+    for(i = 0; i <= MEMORY_CATEGORIES_COUNT; i++)
+        usages[i].peak = usages[i].bytes;
+    pthread_mutex_unlock(&usages_lock);
+}
+
+void memory_report(FILE *file, char *title, int batch) {
+    struct rusage resources;
+    int i;
+    fprintf(file, "Memory of %s:\n", title);
+    pthread_mutex_lock(&usages_lock);
+    for(i = 0; i <= MEMORY_CATEGORIES_COUNT; i++)
+        fprintf(file, "  %s: %lu bytes in %lu objects, peak %lu bytes\n", i < MEMORY_CATEGORIES_COUNT ? get_memory_category_name(i) : "total",
+            (unsigned long) usages[i].bytes, (unsigned long) usages[i].objects, (unsigned long) (batch != false ? usages[i].batch_peak : usages[i].peak));
+    pthread_mutex_unlock(&usages_lock);
+    if(batch != false && getrusage(RUSAGE_SELF, &resources) == 0) /* the resident set size is only known for the whole process */
+        fprintf(file, "  peak resident set size: %li KB\n", (long) resources.ru_maxrss);
+}
+
+char *get_memory_category_name(MEMORY_CATEGORY category) {
+    switch(category) {
+        case MEMORY_LABELS: return "labels";
+        case MEMORY_EXTERNS: return "extern words";
+        case MEMORY_REFERENCES: return "label uses";
+        case MEMORY_INSTRUCTIONS: return "instructions";
+        case MEMORY_MACROS: return "macro lines";
+        case MEMORY_NAMES: return "name strings";
+        case MEMORY_ERRORS: return "error locations";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdio.h>
+
+/**
+ * An enum used for determining the category of the memory that a counted allocation is used for.
+*/
+typedef enum MEMORY_CATEGORY
+{
+    MEMORY_LABELS, /* the label tables and their side tables */
+    MEMORY_EXTERNS, /* the extern uses of the label tables */
+    MEMORY_REFERENCES, /* the label uses of the label tables, kept for the cross-reference file */
+    MEMORY_INSTRUCTIONS, /* the instructions and instruction lists */
+    MEMORY_MACROS, /* the macro tables and the lines of the macros */
+    MEMORY_NAMES, /* the intern pools of the label and macro names */
+    MEMORY_ERRORS, /* the error locations and diagnostics */
+    MEMORY_CATEGORIES_COUNT /* the number of categories, used as the category of allocations that are not counted */
+} MEMORY_CATEGORY;
+
+/**
+ * Sets if the counted allocations are counted, the allocations made while the counting is off are never counted.
+ * @param status true\1 to count the allocations, false\0 otherwise.
+*/
+void memory_set_accounting(int status);
+
+/**
+ * Allocates memory the same way malloc_and_check does, and counts its bytes and object in a given category when the counting is on.
+ * The memory must be freed with free_counted and resized with realloc_counted.
+ * @param size the number of bytes to allocate.
+ * @param category the category of the memory.
+ * @returns the allocated memory.
+*/
+void *malloc_counted(size_t size, MEMORY_CATEGORY category);
+
+/**
+ * Resizes memory that was allocated with malloc_counted the same way realloc_and_check does, and counts the change in its bytes.
+ * If ptr is NULL then a new object is allocated in a given category.
+ * @param ptr the memory to resize, can be NULL.
+ * @param size the new number of bytes.
+ * @param category the category of the memory.
+ * @returns the resized memory.
+*/
+void *realloc_counted(void *ptr, size_t size, MEMORY_CATEGORY category);
+
+/**
+ * Frees memory that was allocated with malloc_counted or realloc_counted and removes it from its category.
+ * @param ptr the memory to free, can be NULL.
+*/
+void free_counted(void *ptr);
+
+/**
+ * Starts the peak of the current file: the peak bytes of every category are set to their current bytes.
+*/
+void memory_start_file();
+
+/**
+ * Writes the current bytes, objects and peak bytes of every category and of all the categories together to a given file.
+ * @param file the file to write the report to.
+ * @param title the name of the report, written in its first line.
+ * @param batch if true\1 then the peaks since the start of the program are written and the peak resident set size of the process,
+ * otherwise the peaks since the last call to memory_start_file.
+*/
+void memory_report(FILE *file, char *title, int batch);
+
+/**
+ * Returns the name of a given memory category.
+ * @param category a given memory category.
+ * @returns the name of the category.
+*/
+char *get_memory_category_name(MEMORY_CATEGORY category);
+
+#endif
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "pipeline.h"
+#include "parallel.h"
+#include "utils.h"
+#include "memory.h"
+
+void set_default_options(assembler_options *options) {
+    options->simulate = false;
+    options->server = false;
+    options->watch = false;
+    options->pipeline = false;
+    options->jobs = 1;
+    options->externs_by_address = false;
+    options->format = DIAGNOSTICS_TEXT;
+    options->max_errors = DIAGNOSTICS_UNLIMITED;
+    options->memory_report = false;
+    options->dependencies = false;
+    options->symbols = false;
+    options->references = false;
+    options->listing = false;
+    options->syntax_only = false;
+    options->fail_fast = false;
+    options->prelude = NULL;
+}
+
+int parse_option(assembler_options *options, int argc, char **argv, int index) {
+    int value;
+    if(strcmp(argv[index], "--simulate") == 0)
+        options->simulate = true;
+    else if(strcmp(argv[index], "--server") == 0)
+        options->server = true;
+    else if(strcmp(argv[index], "--watch") == 0)
+        options->watch = true;
+    else if(strcmp(argv[index], "--pipeline") == 0)
+        options->pipeline = true;
+    else if(strcmp(argv[index], "--ext-by-address") == 0)
+        options->externs_by_address = true;
+    else if(strcmp(argv[index], "--memory-report") == 0)
+        options->memory_report = true;
+    else if(strcmp(argv[index], "--deps") == 0)
+        options->dependencies = true;
+    else if(strcmp(argv[index], "--sym") == 0)
+        options->symbols = true;
+    else if(strcmp(argv[index], "--xref") == 0)
+        options->references = true;
+    else if(strcmp(argv[index], "--lst") == 0)
+        options->listing = true;
+    else if(strcmp(argv[index], "--syntax-only") == 0)
+        options->syntax_only = true;
+    else if(strcmp(argv[index], "--fail-fast") == 0)
+        options->fail_fast = true;
+    else if(strcmp(argv[index], "--jobs") == 0 && argc > index + 1) {
+        value = atoi(argv[index + 1]);
+        if(value < 1)
+            printf("Error: the number of jobs must be a positive integer\n");
+        else
+            options->jobs = value;
+        return 2;
+    }
+    else if(strcmp(argv[index], "--max-errors") == 0 && argc > index + 1) {
+        value = atoi(argv[index + 1]);
+        if(value < 1)
+            printf("Error: the maximum number of errors must be a positive integer\n");
+        else
+            options->max_errors = value;
+        return 2;
+    }
+    else if(strcmp(argv[index], "--prelude") == 0 && argc > index + 1) {
+        options->prelude = argv[index + 1];
+        return 2;
+    }
+    else if(strcmp(argv[index], "--errors-format") == 0 && argc > index + 1) {
+        if(strcmp(argv[index + 1], "json") == 0)
+            options->format = DIAGNOSTICS_JSON;
+        else if(strcmp(argv[index + 1], "sarif") == 0)
+            options->format = DIAGNOSTICS_SARIF;
+        else if(strcmp(argv[index + 1], "text") == 0)
+            options->format = DIAGNOSTICS_TEXT;
+        else
+            printf("Error: the errors format %s is unknown, the formats are text, json and sarif\n", argv[index + 1]);
+        return 2;
+    }
+    else
+        return 0;
+    return 1;
+}
+
+void apply_options(machine *machine, assembler_options *options) {
+    diagnostics *diag = machine_get_diagnostics(machine);
+    int max_errors = options->fail_fast != false ? 1 : options->max_errors; /* a file fails fast by stopping at its first error */
+    if(diagnostics_get_format(diag) != options->format || diagnostics_get_max_errors(diag) != max_errors)
+        machine_set_diagnostics_format(machine, options->format, max_errors);
+    machine_set_externs_order(machine, options->externs_by_address);
+    machine_set_symbol_file(machine, options->symbols);
+    machine_set_references_file(machine, options->references);
+    machine_set_listing_file(machine, options->listing);
+    include_cache_set_dependencies(machine_get_include_cache(machine), options->dependencies);
+    include_cache_set_source_lines(machine_get_include_cache(machine), options->listing);
+    if(options->memory_report != false)
+        memory_set_accounting(true);
+}
+
+int assemble_with_options(machine *machine, assembler_options *options, char *file_name) {
+    reset_machine(machine);
+    memory_start_file();
+    if(options->syntax_only != false)
+        return syntax_only_assembler(machine, file_name);
+    if(options->pipeline != false)
+        return pipelined_assembler(machine, file_name);
+    if(options->jobs > 1)
+        return parallel_assembler(machine, file_name, options->jobs);
+    return full_assembler(machine, file_name);
+}
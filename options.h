@@ -0,0 +1,69 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "assembler.h"
+
+/**
+ * A data structure used for the options that the files are assembled with,
+ * they are given before the file names on the command line or inside a server request.
+*/
+typedef struct assembler_options
+{
+    int simulate; /* if true then the assembled files are simulated, set with the option --simulate */
+    int server; /* if true then the files are received as server requests, set with the option --server */
+    int watch; /* if true then the files are assembled again every time their .as file changes, set with the option --watch */
+    int pipeline; /* if true then the steps of every file run on separate threads, set with the option --pipeline */
+    int jobs; /* the number of threads that the first scan of every file uses, set with the option --jobs N */
+    int externs_by_address; /* if true then the extern file is written by the word numbers, set with the option --ext-by-address */
+    DIAGNOSTICS_FORMAT format; /* the format of the errors, set with the option --errors-format text|json|sarif */
+    int max_errors; /* the number of errors that stops the scan of a file, set with the option --max-errors N */
+    char *prelude; /* the name of the file with the macros that every file can use, set with the option --prelude FILE, NULL if there is no prelude */
+    int memory_report; /* if true then the memory of every file and of all the files is reported, set with the option --memory-report */
+    int dependencies; /* if true then the Make dependency file (.d) of every file is written, set with the option --deps */
+    int symbols; /* if true then the symbol file (.sym) of every file is written, set with the option --sym */
+    int references; /* if true then the cross-reference file (.xref) of every file is written, set with the option --xref */
+    int listing; /* if true then the listing file (.lst) of every file is written, set with the option --lst */
+    int syntax_only; /* if true then the files are only checked for errors and no file is written, set with the option --syntax-only */
+    int fail_fast; /* if true then a file stops at its first error and the files after it are not assembled, set with the option --fail-fast */
+} assembler_options;
+
+/**
+ * Sets the default options: every file is assembled on one thread and its errors are printed as text without a limit.
+ * @param options the options to set.
+*/
+void set_default_options(assembler_options *options);
+
+/**
+ * Reads the option at a given index of a given arguments array into given options.
+ * If the value of an option is illegal then an error is printed and the option keeps its value.
+ * @param options the options to set.
+ * @param argc the number of arguments.
+ * @param argv the arguments.
+ * @param index the index of the option in the arguments.
+ * @returns the number of arguments the option used, returns 0 if the argument is not an option.
+*/
+int parse_option(assembler_options *options, int argc, char **argv, int index);
+
+/**
+ * Sets the diagnostics format, the extern file order, the symbol, cross-reference and listing files of a given machine to given options,
+ * the diagnostics of the machine are replaced only if their format or maximum number of errors changed. 
+ * If the memory is reported then the counting of the memory categories is started. 
+ * The include cache of the machine is set to write the dependency files and to keep the source lines of the listing files if the options write them. 
+ * With the option --fail-fast the diagnostics stop the scan of a file at its first error.
+ * @param machine a given machine.
+ * @param options the options to use.
+*/
+void apply_options(machine *machine, assembler_options *options);
+
+/**
+ * Resets a given machine and assembles a given file with the assembler that given options choose:
+ * syntax_only_assembler, pipelined_assembler, parallel_assembler or full_assembler. The errors are kept in the diagnostics of the machine. 
+ * The peak memory of the file is counted from after the reset, so the memory of the file before it is not included.
+ * @param machine a given machine that the options were applied to.
+ * @param options the options to use.
+ * @param file_name a given file name without extension.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int assemble_with_options(machine *machine, assembler_options *options, char *file_name);
+
+#endif
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "parallel.h"
+#include "pre_assembler.h"
+#include "utils.h"
+
+/**
+ * A data structure used for the thread of one chunk: its lines and its machine, that keeps the errors it found.
+*/
+typedef struct scan_chunk
+{
+    text_reader lines; /* the lines of the chunk */
+    int first_line; /* the number of lines the first scan reads before the chunk */
+    char *file_name; /* the file name without extension */
+    machine *machine; /* the machine that scans the chunk */
+    int error; /* true\1 if the chunk has errors */
+    pthread_t thread; /* the thread that scans the chunk */
+    int started; /* true\1 if the thread was created */
+} scan_chunk;
+
+/**
+ * A data structure used for the thread of one range of instructions to convert.
+*/
+typedef struct encode_range
+{
+    char *text; /* the part of the text to write the range lines into */
+    instruction *instruct; /* the first instruction of the range */
+    int count; /* the number of instructions in the range */
+    int IC; /* the number of the range first word */
+    int width; /* the number of digits of the word numbers */
+    pthread_t thread; /* the thread that converts the range */
+    int started; /* true\1 if the thread was created */
+} encode_range;
+
+/**
+ * Does the first scan commands of a given chunk with its own machine, used as the thread of every chunk.
+ * @param context a given chunk.
+ * @returns NULL.
+*/
+void *parallel_scan_chunk(void *context) {
+    scan_chunk *chunk = (scan_chunk*) context;
+    line_reader *reader = create_block_line_reader(read_text_block, &chunk->lines);
+    error_location *error_info = create_empty_error_location(get_file_full_name(chunk->file_name, ".am"));
+    error_location_set_diagnostics(error_info, machine_get_diagnostics(chunk->machine));
+    error_location_set_line(error_info, chunk->first_line);
+    chunk->error = assembler_first_scan_commands(chunk->machine, reader, error_info);
+    free_error_location(error_info);
+    free_line_reader(reader);
+    return NULL;
+}
+
+int parallel_first_scan(machine *machine, char *file_name, int jobs) {
+    scan_chunk chunks[PARALLEL_MAX_JOBS];
+    int chunks_count, i;
+    int merged = true; /* false if the chunks could not be merged and the file must be scanned again */
+    int error = false;
+    size_t length, start, end;
+    char *text, *line_end;
+    if(jobs > PARALLEL_MAX_JOBS)
+        jobs = PARALLEL_MAX_JOBS;
+    text = read_text_file(file_name, ".am", &length);
+    if(text == NULL)
+        return true;
+    chunks_count = length / PARALLEL_MIN_CHUNK_SIZE + 1;
+    if(chunks_count > jobs)
+        chunks_count = jobs;
+    if(chunks_count <= 1 || diagnostics_limit_reached(machine_get_diagnostics(machine))) { /* a small file is scanned on its own, and a file that reached the maximum number of errors is not scanned */
+        free(text);
+        return assembler_first_scan(machine, file_name);
+    }
+    start = 0;
+    for(i = 0; i < chunks_count; i++) { /* every chunk ends after a new line character, so the chunks lines are the same lines the whole file has */
+        end = i == chunks_count - 1 ? length : length / chunks_count * (i + 1);
+        if(end < start)
+            end = start;
+        if(end < length && end > 0 && text[end - 1] != '\n') {
+            line_end = (char*) memchr(&text[end], '\n', length - end);
+            end = line_end != NULL ? (size_t) (line_end - text) + 1 : length;
+        }
+        chunks[i].lines.text = &text[start];
+        chunks[i].lines.length = end - start;
+        chunks[i].lines.position = 0;
+        chunks[i].first_line = i == 0 ? 0 : chunks[i-1].first_line + count_text_lines(chunks[i-1].lines.text, chunks[i-1].lines.length);
+        chunks[i].file_name = file_name;
+        chunks[i].machine = initialize_machine();
+        machine_set_chunk_status(chunks[i].machine, true);
+        machine_set_diagnostics_format(chunks[i].machine, diagnostics_get_format(machine_get_diagnostics(machine)), diagnostics_get_max_errors(machine_get_diagnostics(machine)));
+        chunks[i].error = false;
+        chunks[i].started = pthread_create(&chunks[i].thread, NULL, parallel_scan_chunk, &chunks[i]) == 0;
+        start = end;
+    }
+    for(i = 0; i < chunks_count; i++) {
+        if(chunks[i].started)
+            pthread_join(chunks[i].thread, NULL);
+        else /* without a thread the chunk is scanned on the current thread */
+            parallel_scan_chunk(&chunks[i]);
+    }
+    for(i = 0; i < chunks_count && merged != false; i++) {
+        merged = machine_merge_chunk(machine, chunks[i].machine, false);
+        error = error || chunks[i].error;
+    }
+    for(i = 0; i < chunks_count; i++) {
+        if(merged != false) /* the errors of every chunk are added in the order of the lines, until the maximum number of errors */
+            diagnostics_append(machine_get_diagnostics(machine), machine_get_diagnostics(chunks[i].machine));
+        free_machine(chunks[i].machine);
+    }
+    free(text);
+    if(merged == false) { /* a label was declared in 2 chunks or the data overflowed, the errors are found by scanning the whole file */
+        reset_machine(machine);
+        return assembler_first_scan(machine, file_name);
+    }
+    assembler_first_scan_finish(machine); /* the labels are initiated even if the file has errors, so the second scan can check the other lines */
+    return error;
+}
+
+/**
+ * Converts the instructions of a given range, used as the thread of every range.
+ * @param context a given range.
+ * @returns NULL.
+*/
+void *parallel_encode_range(void *context) {
+    encode_range *range = (encode_range*) context;
+    encode_instructions(NULL, range->text, range->instruct, range->count, range->IC, range->width);
+    return NULL;
+}
+
+void parallel_encode_instructions(void *context, char *text, instruction *instruct, int count, int IC, int width) {
+    encode_range ranges[PARALLEL_MAX_JOBS];
+    int jobs = *(int*) context;
+    int ranges_count, i, j, words = 0;
+    if(jobs > PARALLEL_MAX_JOBS)
+        jobs = PARALLEL_MAX_JOBS;
+    ranges_count = count / PARALLEL_MIN_ENCODE_COUNT + 1;
+    if(ranges_count > jobs)
+        ranges_count = jobs;
+    if(ranges_count <= 1) { /* few instructions are converted on the current thread */
+        encode_instructions(NULL, text, instruct, count, IC, width);
+        return;
+    }
+    for(i = 0; i < ranges_count; i++) { /* the words before every range give its first word number and its text position */
+        ranges[i].text = &text[get_words_length(words, width)];
+        ranges[i].instruct = instruct;
+        ranges[i].count = i == ranges_count - 1 ? count - count / ranges_count * i : count / ranges_count;
+        ranges[i].IC = IC + words;
+        ranges[i].width = width;
+        for(j = 0; j < ranges[i].count; j++) {
+            words += instruction_get_words_count(instruct);
+            instruct = get_next_instruction(instruct);
+        }
+    }
+    for(i = 0; i < ranges_count; i++)
+        ranges[i].started = pthread_create(&ranges[i].thread, NULL, parallel_encode_range, &ranges[i]) == 0;
+    for(i = 0; i < ranges_count; i++) {
+        if(ranges[i].started)
+            pthread_join(ranges[i].thread, NULL);
+        else /* without a thread the range is converted on the current thread */
+            parallel_encode_range(&ranges[i]);
+    }
+}
+
+int parallel_assembler(machine *machine, char *file_name, int jobs) {
+    int assembled;
+    int error = pre_assembler(file_name, machine_get_diagnostics(machine), machine_get_prelude(machine), machine_get_include_cache(machine));
+    if(error == PRE_ASSEMBLER_NO_FILE)
+        return false;
+    if(parallel_first_scan(machine, file_name, jobs) != false) /* every step runs so all the errors are printed, as full_assembler does */
+        error = true;
+    if(assembler_second_scan(machine, file_name) != false)
+        error = true;
+    if(error != false)
+        return false;
+    machine_set_instructions_encoder(machine, parallel_encode_instructions, &jobs);
+    assembled = convert_to_machine_code(machine, file_name);
+    machine_set_instructions_encoder(machine, NULL, NULL);
+    return assembled;
+}
@@ -0,0 +1,49 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "assembler.h"
+
+#define PARALLEL_MAX_JOBS 64 /* the maximum number of threads that scan the chunks of a file */
+#define PARALLEL_MIN_CHUNK_SIZE 4096 /* the minimum number of characters in a chunk, smaller files are split into fewer chunks */
+#define PARALLEL_MIN_ENCODE_COUNT 4096 /* the minimum number of instructions that a thread converts, fewer instructions are converted by fewer threads */
+
+/**
+ * Does the first assembler scan of a given file the same way assembler_first_scan does, 
+ * but splits the .am file at line boundaries into chunks that are scanned on up to a given number of threads. 
+ * Every chunk is scanned with its own machine and its errors are kept, then the chunks are merged in their order: 
+ * the labels values are rebased by the IC and DC of the chunks before them and the errors are added to the machine diagnostics in order. 
+ * If a label was declared in 2 chunks or the data does not fit in MAX_DATA then the file is scanned again without chunks, 
+ * so the errors are the same as assembler_first_scan finds.
+ * @param machine a given machine to use.
+ * @param file_name a given file name without extension.
+ * @param jobs the maximum number of threads to use.
+ * @returns false if the file does not have errors, retrns true otherwise
+*/
+int parallel_first_scan(machine *machine, char *file_name, int jobs);
+
+/**
+ * Converts a given number of instructions into the object file lines of their words the same way encode_instructions does, 
+ * but splits the instructions into ranges that are converted on up to a given number of threads. 
+ * The first word number and the text position of every range are computed before converting, from the sum of the words counts of the instructions before it, 
+ * so every thread writes into its own part of the text.
+ * @param context a given pointer to the maximum number of threads to use.
+ * @param text a given text to write the lines into.
+ * @param instruct the first instruction to convert.
+ * @param count the number of instructions to convert.
+ * @param IC the number of the first instruction first word.
+ * @param width the number of digits of the word numbers.
+*/
+void parallel_encode_instructions(void *context, char *text, instruction *instruct, int count, int IC, int width);
+
+/**
+ * Activates the pre assembler, first assembler scan, second assembler scan 
+ * and the conversion from machine to code, the same way full_assembler does, 
+ * but the first scan is done with parallel_first_scan and the instructions are converted with parallel_encode_instructions.
+ * @param machine the current machine to use.
+ * @param file_name a given file name without extension.
+ * @param jobs the maximum number of threads to use.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int parallel_assembler(machine *machine, char *file_name, int jobs);
+
+#endif
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pipeline.h"
+#include "pre_assembler.h"
+#include "utils.h"
+
+/**
+ * A data structure used for passing items from one thread to another in the order they were pushed. 
+ * The queue is bounded: a thread that pushes into a full queue waits until the other thread pops an item.
+*/
+typedef struct pipeline_queue
+{
+    void *items[PIPELINE_QUEUE_SIZE]; /* the items inside the queue */
+    size_t lengths[PIPELINE_QUEUE_SIZE]; /* the length of every item inside the queue */
+    int head; /* the index of the first item */
+    int count; /* the number of items inside the queue */
+    pthread_mutex_t lock; /* protects the queue from being changed by both threads at the same time */
+    pthread_cond_t not_empty; /* signaled when an item is pushed */
+    pthread_cond_t not_full; /* signaled when an item is popped */
+} pipeline_queue;
+
+/**
+ * A data structure used for the pre assembler thread: its files, the queue it fills and the errors it found.
+*/
+typedef struct pre_assembler_stage
+{
+    char *file_name; /* the file name without extension */
+    FILE *input; /* the .as file to read */
+    FILE *output; /* the .am file to write */
+    pipeline_queue *lines; /* the queue of the expanded lines blocks */
+    int errors; /* true\1 if the pre assembler found errors */
+    diagnostics *diagnostics; /* the diagnostics to add the pre assembler errors into */
+    macro_table *prelude; /* the read-only macros that the file can use, shared with the other threads */
+    include_cache *include_cache; /* the included files of the run, only the pre assembler thread uses it */
+} pre_assembler_stage;
+
+/**
+ * A data structure used for reading the expanded lines blocks of a queue as a line reader source.
+*/
+typedef struct queue_reader
+{
+    pipeline_queue *queue; /* the queue to read the blocks from */
+    char *block; /* the current block */
+    size_t length; /* the number of characters inside the current block */
+    size_t position; /* the index of the next character to read in the current block */
+    int ended; /* true\1 after the last block was read */
+} queue_reader;
+
+/**
+ * A data structure used for the encoder thread: the queue of the final instructions and the buffer to convert them into.
+*/
+typedef struct encoder_stage
+{
+    pipeline_queue *instructions; /* the queue of the instructions that their operands are final */
+    output_buffer *words; /* the converted instructions words */
+    int IC; /* the IC after the last converted word */
+    int width; /* the number of digits of the word numbers, chosen by the counters of the first scan */
+} encoder_stage;
+
+/**
+ * Creates an empty pipeline queue.
+ * @returns the newly created queue.
+*/
+pipeline_queue *create_pipeline_queue() {
+    pipeline_queue *queue = (pipeline_queue*) malloc_and_check(sizeof(pipeline_queue));
+    queue->head = 0;
+    queue->count = 0;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return queue;
+}
+
+/**
+ * Pushes a given item with a given length to the end of a given queue, if the queue is full then waits until it is not.
+ * @param queue a given queue.
+ * @param item a given item, NULL is used to inform that no more items will be pushed.
+ * @param length the length of the item.
+*/
+void pipeline_queue_push(pipeline_queue *queue, void *item, size_t length) {
+    int index;
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == PIPELINE_QUEUE_SIZE)
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    index = (queue->head + queue->count) % PIPELINE_QUEUE_SIZE;
+    queue->items[index] = item;
+    queue->lengths[index] = length;
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * Pops the first item of a given queue, if the queue is empty then waits until an item is pushed.
+ * @param queue a given queue.
+ * @param length a pointer to store the item length, can be NULL.
+ * @returns the first item of the queue.
+*/
+void *pipeline_queue_pop(pipeline_queue *queue, size_t *length) {
+    void *item;
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0)
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    item = queue->items[queue->head];
+    if(length != NULL)
+        *length = queue->lengths[queue->head];
+    queue->head = (queue->head + 1) % PIPELINE_QUEUE_SIZE;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
+/**
+ * Free the memory a given queue contains from the system memory, the items are not freed.
+ * @param queue a given queue.
+*/
+void free_pipeline_queue(pipeline_queue *queue) {
+    if(queue == NULL) return;
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue);
+}
+
+/**
+ * Writes a block of expanded lines to the .am file and pushes a copy of it to the first scan, used as the block writer of the pre assembler stage.
+ * @param context a given pre assembler stage.
+ * @param block a given block.
+ * @param length the number of characters inside the block.
+*/
+void pipeline_write_lines_block(void *context, const char *block, size_t length) {
+    pre_assembler_stage *stage = (pre_assembler_stage*) context;
+    char *copy = (char*) malloc_and_check(length);
+    fwrite(block, 1, length, stage->output);
+    memcpy(copy, block, length);
+    pipeline_queue_push(stage->lines, copy, length);
+}
+
+/**
+ * Runs the pre assembler of a given pre assembler stage, used as the pre assembler thread.
+ * @param context a given pre assembler stage.
+ * @returns NULL.
+*/
+void *pipeline_pre_assembler(void *context) {
+    pre_assembler_stage *stage = (pre_assembler_stage*) context;
+    output_buffer *writer = create_block_output_buffer(pipeline_write_lines_block, stage);
+    stage->errors = pre_assembler_expand(stage->file_name, stage->input, writer, stage->diagnostics, stage->prelude, stage->include_cache);
+    free_output_buffer(writer);
+    pipeline_queue_push(stage->lines, NULL, 0); /* informs the first scan that there are no more lines */
+    return NULL;
+}
+
+/**
+ * Reads the next characters of the expanded lines blocks queue, used as the block reader of the first scan.
+ * @param context a given queue reader.
+ * @param block a given block to read into.
+ * @param size the size of the block.
+ * @returns the number of characters read, returns 0 after the last block.
+*/
+size_t pipeline_read_lines_block(void *context, char *block, size_t size) {
+    queue_reader *reader = (queue_reader*) context;
+    size_t count;
+    if(reader->position == reader->length) { /* the current block was read, pop the next block */
+        free(reader->block);
+        reader->block = NULL;
+        reader->length = 0;
+        reader->position = 0;
+        if(reader->ended)
+            return 0;
+        reader->block = (char*) pipeline_queue_pop(reader->queue, &reader->length);
+        if(reader->block == NULL) {
+            reader->ended = true;
+            return 0;
+        }
+    }
+    count = reader->length - reader->position;
+    if(count > size)
+        count = size;
+    memcpy(block, &reader->block[reader->position], count);
+    reader->position += count;
+    return count;
+}
+
+/**
+ * Pushes a given instruction to the encoder thread, used as the instruction listener of the second scan.
+ * @param context a given encoder stage.
+ * @param instruct a given instruction.
+*/
+void pipeline_push_instruction(void *context, instruction *instruct) {
+    pipeline_queue_push(((encoder_stage*) context)->instructions, instruct, 0);
+}
+
+/**
+ * Converts every instruction of the encoder stage queue into words, used as the encoder thread.
+ * @param context a given encoder stage.
+ * @returns NULL.
+*/
+void *pipeline_encoder(void *context) {
+    encoder_stage *stage = (encoder_stage*) context;
+    instruction *instruct;
+    while((instruct = (instruction*) pipeline_queue_pop(stage->instructions, NULL)) != NULL)
+        add_instruction_to_buffer(stage->words, instruct, &stage->IC, stage->width);
+    return NULL;
+}
+
+/**
+ * Does the second scan while an encoder thread converts the instructions that the scan finishes, 
+ * and creates the object, entry and extern files if the scan and the steps before it had no errors.
+ * @param machine the current machine to use.
+ * @param file_name a given file name without extension.
+ * @param earlier_errors true\1 if the steps before the second scan had errors.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int pipelined_second_scan(machine *machine, char *file_name, int earlier_errors) {
+    encoder_stage stage;
+    pthread_t encoder;
+    int error;
+    stage.instructions = create_pipeline_queue();
+    stage.words = create_memory_output_buffer();
+    stage.IC = IC_START;
+    stage.width = machine_get_address_width(machine); /* the first scan ended, so the last word number is known */
+    if(pthread_create(&encoder, NULL, pipeline_encoder, &stage) != 0) { /* without a thread the steps run one after the other */
+        free_pipeline_queue(stage.instructions);
+        free_output_buffer(stage.words);
+        if(assembler_second_scan(machine, file_name) != false || earlier_errors != false)
+            return false;
+        return convert_to_machine_code(machine, file_name);
+    }
+    machine_set_instruction_listener(machine, pipeline_push_instruction, &stage);
+    error = assembler_second_scan(machine, file_name) || earlier_errors;
+    machine_set_instruction_listener(machine, NULL, NULL);
+    pipeline_queue_push(stage.instructions, NULL, 0); /* informs the encoder that there are no more instructions */
+    pthread_join(encoder, NULL);
+    free_pipeline_queue(stage.instructions);
+    if(error == false)
+        error = write_machine_code(machine, file_name, stage.words, stage.IC, stage.width) == false;
+    free_output_buffer(stage.words);
+    return error == false;
+}
+
+int pipelined_assembler(machine *machine, char *file_name) {
+    pre_assembler_stage stage;
+    queue_reader lines;
+    pthread_t pre_assembler_thread;
+    line_reader *reader;
+    error_location *error_info; /* the error location of the first scan */
+    diagnostics *errors; /* the errors of the first scan, added after the pre assembler errors when the pre assembler finishes */
+    char command[MAX_COMMAND_LEN]; /* the lines that the first scan did not read */
+    int error;
+    stage.file_name = file_name;
+    stage.errors = false;
+    stage.diagnostics = machine_get_diagnostics(machine); /* only the pre assembler thread adds errors to it until the thread is joined */
+    stage.prelude = machine_get_prelude(machine);
+    stage.include_cache = machine_get_include_cache(machine);
+    stage.input = open_file(file_name, ".as", "r");
+    if(stage.input == NULL)
+        return false;
+    stage.output = open_file(file_name, ".am", "w");
+    if(stage.output == NULL) {
+        fclose(stage.input);
+        return false;
+    }
+    stage.lines = create_pipeline_queue();
+    if(pthread_create(&pre_assembler_thread, NULL, pipeline_pre_assembler, &stage) != 0) { /* without a thread the steps run one after the other */
+        fclose(stage.output);
+        fclose(stage.input);
+        free_pipeline_queue(stage.lines);
+        return full_assembler(machine, file_name);
+    }
+    lines.queue = stage.lines;
+    lines.block = NULL;
+    lines.length = 0;
+    lines.position = 0;
+    lines.ended = false;
+    reader = create_block_line_reader(pipeline_read_lines_block, &lines);
+    errors = create_diagnostics(diagnostics_get_format(stage.diagnostics), diagnostics_get_max_errors(stage.diagnostics));
+    error_info = create_empty_error_location(get_file_full_name(file_name, ".am"));
+    error_location_set_diagnostics(error_info, errors);
+    error = assembler_first_scan_lines(machine, reader, error_info);
+    while(line_reader_gets(reader, command, MAX_COMMAND_LEN) != NULL) /* the lines after the maximum number of errors are read until the last block, so the pre assembler never waits forever */
+        ;
+    pthread_join(pre_assembler_thread, NULL);
+    fclose(stage.output);
+    fclose(stage.input);
+    free_line_reader(reader);
+    free_pipeline_queue(stage.lines);
+    free_error_location(error_info);
+    diagnostics_append(stage.diagnostics, errors); /* added after the pre assembler errors until the maximum number of errors, as full_assembler adds them */
+    free_diagnostics(errors);
+    return pipelined_second_scan(machine, file_name, stage.errors != false || error != false);
+}
@@ -0,0 +1,20 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "assembler.h"
+
+#define PIPELINE_QUEUE_SIZE 64 /* the number of blocks or instructions a pipeline queue holds before the stage that fills it waits */
+
+/**
+ * Activates the pre assembler, first assembler scan, second assembler scan 
+ * and the conversion from machine to code, the same way full_assembler does, but overlaps the steps on separate threads: 
+ * the pre assembler runs on its own thread and passes every block of expanded lines it writes to the first scan through a bounded queue, 
+ * and while the second scan runs every instruction that its operands are final is passed through a bounded queue to an encoder thread. 
+ * The errors of the first scan are kept until the pre assembler finishes, so the errors are added in the same order as full_assembler adds them.
+ * @param machine the current machine to use.
+ * @param file_name a given file name without extension.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int pipelined_assembler(machine *machine, char *file_name);
+
+#endif
@@ -4,23 +4,16 @@
 #include <ctype.h>
 #include "pre_assembler.h"
 #include "utils.h"
-
-struct line_t
-{
-    char *line_context; /* the line context of the current line */
-    struct line_t *next; /* the next line */
-};
-
-struct line_list_t
-{
-    line *head; /* the first line in the list */
-    line *root; /* the last line in the list */
-};
+#include "intern.h"
+#include "memory.h"
 
 struct macro_t
 {
-    char *name; /* the macro name */
-    line_list *lines; /* the lines that the macro contains */
+    char *name; /* the macro name, stored inside the intern pool of its macro table */
+    char *text; /* the lines that the macro contains, one after the other */
+    size_t length; /* the number of characters inside the text */
+    size_t text_size; /* the number of characters the text can contain */
+    int lines_count; /* the number of lines the macro contains */
     struct macro_t *next; /* the next macro */
 };
 
@@ -28,38 +21,547 @@ struct macro_table_t
 {
     macro *head; /* the first macro in the list */
     macro *root; /* the last macro in the list */
+    intern_pool *names; /* the names of the macros, every name is stored once */
+    macro **named; /* the macro of every name id, used for searching macros by name */
+    int named_size; /* the number of name ids the named array can contain */
+    macro_table *prelude; /* the read-only table that is searched after this table, can be NULL */
+    macro_table **includes; /* the tables of the included files, searched after this table and before the prelude */
+    int includes_count; /* the number of included tables */
+    int includes_size; /* the number of tables the includes array can contain */
+};
+
+/**
+ * A data structure used for one file of an include cache: its expanded lines and its macros, 
+ * they are kept for the rest of the run and used again by every include of the file while its text and the texts of the files it includes do not change.
+ * A file that changed is stale: it is not found by its name anymore, and it is freed when no cached file includes it and the current file does not use it.
+*/
+typedef struct included_file
+{
+    char *name; /* the path of the file: the name written in the include, from the directory of the including file */
+    unsigned long hash; /* the hash of the text of the file */
+    size_t size; /* the number of characters of the text of the file */
+    char *text; /* the expanded lines of the file */
+    size_t length; /* the number of characters of the expanded lines */
+    int lines_count; /* the number of the expanded lines */
+    char *dependencies; /* the names of the files that the file includes, every name after a space */
+    macro_table *macros; /* the macros that the file declared, read-only after the file was expanded */
+    struct included_file **includes; /* the files that the file includes, their macro tables are searched by its macro table */
+    int includes_count; /* the number of files inside the includes array */
+    int includes_size; /* the number of files the includes array can contain */
+    int references; /* the number of includes of the file by other cached files, the file is not freed while it is included */
+    int expanding; /* true\1 while the lines of the file are expanded, then including it again is a cycle */
+    int stale; /* true\1 if the file or a file it includes changed, then it is only kept until it is not used */
+    int used_by; /* the number of the last file that included it */
+    int checked_by; /* the number of the last file that checked if the texts of the file changed */
+    int unchanged; /* true\1 if the texts of the file did not change in the last check */
+    struct included_file *next; /* the next file in the cache */
+} included_file;
+
+struct include_cache_t
+{
+    included_file *head; /* the first file in the cache */
+    output_buffer *dependencies; /* the names of the files that the current file included, every name after a space */
+    included_file *expanding; /* the included file that its lines are expanded now, NULL while the lines of the current file are expanded */
+    int dependencies_status; /* true\1 if the dependency file of every file is written */
+    int current; /* the number of the current file, counts the files that were expanded with the cache */
+    output_buffer *source_writer; /* the writer of the expanded lines of the current file, only the lines written into it are mapped */
+    int *source_lines; /* the line of the .as file of every expanded line of the current file */
+    int source_count; /* the number of mapped expanded lines */
+    int source_size; /* the number of lines the source lines array can contain */
+    int source_status; /* true\1 if the source lines of every file are kept */
 };
 
-int pre_assembler(char *file_name) {
+/**
+ * Free the memory a given included file contains from the system memory, without the files after it.
+ * @param file a given included file.
+*/
+void free_included_file(included_file *file) {
+    if(file == NULL) return;
+    free(file->name);
+    free_counted(file->text);
+    free(file->dependencies);
+    free_macro_table(file->macros);
+    free(file->includes);
+    free(file);
+}
+
+/**
+ * Removes a given file from a given include cache and frees it, the files it includes lose its references.
+ * @param cache a given include cache.
+ * @param file a given file of the cache that no cached file includes.
+*/
+void remove_included_file(include_cache *cache, included_file *file) {
+    included_file **link;
+    int i;
+    for(link = &cache->head; *link != NULL && *link != file; link = &(*link)->next)
+        ;
+    if(*link != NULL)
+        *link = file->next;
+    for(i = 0; i < file->includes_count; i++)
+        file->includes[i]->references--;
+    free_included_file(file);
+}
+
+/**
+ * Frees the stale files of a given include cache that no cached file includes and that the current file does not use. 
+ * A freed file can be the last file that included another stale file, so the files are checked again after every freed file.
+ * @param cache a given include cache.
+*/
+void include_cache_collect(include_cache *cache) {
+    included_file *file = cache->head;
+    while(file != NULL) {
+        if(file->stale != false && file->references == 0 && file->used_by != cache->current) {
+            remove_included_file(cache, file);
+            file = cache->head;
+        }
+        else
+            file = file->next;
+    }
+}
+
+int pre_assembler(char *file_name, diagnostics *diag, macro_table *prelude, include_cache *cache) {
+    FILE *input; /* the .as file to read */
+    FILE *output; /* the .am file to write */
+    output_buffer *writer; /* writes the .am file in blocks */
+    int file_errors;
+    input = open_file(file_name, ".as", "r");
+    if(input == NULL) /* check if the .as file had been opened successfully */
+        return PRE_ASSEMBLER_NO_FILE;
+    output = open_file(file_name, ".am", "w");
+    if(output == NULL) { /* check if the .am file had been opened successfully */
+        fclose(input); /* close the .as file to insure safety */
+        return PRE_ASSEMBLER_NO_FILE;
+    }
+    writer = create_output_buffer(output);
+    file_errors = pre_assembler_expand(file_name, input, writer, diag, prelude, cache);
+    free_output_buffer(writer); /* writes the last block of the .am file */
+    fclose(output); /* closes the files to insure safety */
+    fclose(input);
+    return file_errors;
+}
+
+/**
+ * Writes the Make dependency file of a given file: its .am and .ob files depend on its .as file and on every file it included.
+ * The file is written only when its text changed, so its modification time is kept.
+ * @param file_name the file name without extension.
+ * @param cache the include cache that the file was expanded with.
+*/
+void write_dependency_file(char *file_name, include_cache *cache) {
+    output_buffer *text = create_memory_output_buffer();
+    output_buffer_puts(text, file_name);
+    output_buffer_puts(text, ".am ");
+    output_buffer_puts(text, file_name);
+    output_buffer_puts(text, ".ob: ");
+    output_buffer_puts(text, file_name);
+    output_buffer_puts(text, ".as");
+    output_buffer_write(text, output_buffer_get_text(cache->dependencies), output_buffer_get_length(cache->dependencies));
+    output_buffer_puts(text, "\n");
+    write_text_file(file_name, ".d", output_buffer_get_text(text), output_buffer_get_length(text), true);
+    free_output_buffer(text);
+}
+
+int pre_assembler_expand(char *file_name, FILE *input, output_buffer *writer, diagnostics *diag, macro_table *prelude, include_cache *cache) {
+    macro_table *macro_table = create_empty_macro_table(); /* the macros of the file, the prelude macros are searched after them */
+    error_location *error_info = create_empty_error_location(get_file_full_name(file_name, ".as")); /* the error location to print when an error occurs */
+    include_cache *own_cache = cache == NULL ? create_include_cache() : NULL; /* without a cache the included files are kept only for this file */
+    line_reader *reader = create_line_reader(input); /* reads the .as file in blocks */
+    int file_errors;
+    if(own_cache != NULL)
+        cache = own_cache;
+    cache->current++;
+    include_cache_collect(cache); /* the stale files that the last file used are not used anymore */
+    output_buffer_clear(cache->dependencies);
+    cache->source_writer = writer;
+    cache->source_count = 0;
+    macro_table_set_prelude(macro_table, prelude);
+    error_location_set_diagnostics(error_info, diag);
+    file_errors = pre_assembler_expand_macros(error_info, reader, writer, macro_table, cache);
+    cache->source_writer = NULL;
+    if(cache->dependencies_status != false)
+        write_dependency_file(file_name, cache);
+    free_line_reader(reader);
+    free_macro_table(macro_table); /* free the macro table, the included tables belong to the cache */
+    free_error_location(error_info);
+    free_include_cache(own_cache);
+    return file_errors;
+}
+
+include_cache *create_include_cache() {
+    include_cache *cache = (include_cache*) malloc_and_check(sizeof(include_cache));
+    cache->head = NULL;
+    cache->dependencies = create_memory_output_buffer();
+    cache->expanding = NULL;
+    cache->dependencies_status = false;
+    cache->current = 0;
+    cache->source_writer = NULL;
+    cache->source_lines = NULL;
+    cache->source_count = 0;
+    cache->source_size = 0;
+    cache->source_status = false;
+    return cache;
+}
+
+void include_cache_set_dependencies(include_cache *cache, int status) {
+    if(cache != NULL)
+        cache->dependencies_status = status;
+}
+
+void include_cache_set_source_lines(include_cache *cache, int status) {
+    if(cache != NULL)
+        cache->source_status = status;
+}
+
+/**
+ * Maps a given number of lines that were written into a given output buffer to a given line of the .as file, 
+ * only if the include cache keeps the source lines and the output buffer is the writer of the current file. 
+ * The array is doubled when it is full.
+ * @param cache a given include cache, can be NULL.
+ * @param writer the output buffer that the lines were written into.
+ * @param line the line of the .as file.
+ * @param count the number of lines that were written.
+*/
+void include_cache_add_source_lines(include_cache *cache, output_buffer *writer, int line, int count) {
+    if(cache == NULL || cache->source_status == false || writer != cache->source_writer)
+        return;
+    if(cache->source_count + count > cache->source_size) {
+        if(cache->source_size == 0)
+            cache->source_size = SOURCE_LINES_START_SIZE;
+        while(cache->source_count + count > cache->source_size)
+            cache->source_size *= 2;
+        cache->source_lines = (int*) realloc_and_check(cache->source_lines, sizeof(int) * cache->source_size);
+    }
+    for(; count > 0; count--)
+        cache->source_lines[cache->source_count++] = line;
+}
+
+int include_cache_get_source_line(include_cache *cache, int line) {
+    if(cache == NULL || line < 1 || line > cache->source_count)
+        return 0;
+    return cache->source_lines[line - 1];
+}
+
+char *include_cache_get_dependencies(include_cache *cache, size_t *length) {
+    *length = output_buffer_get_length(cache->dependencies);
+    return output_buffer_get_text(cache->dependencies);
+}
+
+void include_cache_clear(include_cache *cache) {
+    included_file *file;
+    if(cache == NULL) return;
+    for(file = cache->head; file != NULL; file = file->next)
+        file->stale = true;
+    include_cache_collect(cache);
+}
+
+void free_include_cache(include_cache *cache) {
+    included_file *file, *next;
+    if(cache == NULL) return;
+    for(file = cache->head; file != NULL; file = next) {
+        next = file->next;
+        free_included_file(file);
+    }
+    free_output_buffer(cache->dependencies);
+    free(cache->source_lines);
+    free(cache);
+}
+
+/**
+ * Adds a given included file to the files that another given included file includes, so it is not freed while the other file uses its macros.
+ * @param file a given included file.
+ * @param included the file that it includes.
+*/
+void included_file_add_include(included_file *file, included_file *included) {
+    if(file->includes_count == file->includes_size) {
+        file->includes_size = file->includes_size > 0 ? file->includes_size * 2 : MACRO_INCLUDES_START_SIZE;
+        file->includes = (included_file**) realloc_and_check(file->includes, sizeof(included_file*) * file->includes_size);
+    }
+    file->includes[file->includes_count++] = included;
+    included->references++;
+}
+
+/**
+ * Checks if the text of a given included file and the texts of every file it includes, directly or through other files, did not change since it was expanded. 
+ * Every file is read once for every file that is expanded with the cache, the result is kept until the next file.
+ * @param cache a given include cache.
+ * @param file a given included file.
+ * @returns true\1 if the texts did not change, returns false\0 otherwise.
+*/
+int included_file_unchanged(include_cache *cache, included_file *file) {
+    FILE *input;
+    char *text = NULL;
+    size_t size = 0;
+    int i;
+    if(file->checked_by == cache->current)
+        return file->unchanged;
+    input = fopen(file->name, "r");
+    if(input != NULL) {
+        text = read_text_stream(input, &size);
+        fclose(input);
+    }
+    file->checked_by = cache->current;
+    file->unchanged = text != NULL && size == file->size && hash_text(HASH_START, text, size) == file->hash;
+    free(text);
+    for(i = 0; i < file->includes_count && file->unchanged != false; i++)
+        file->unchanged = included_file_unchanged(cache, file->includes[i]);
+    return file->unchanged;
+}
+
+/**
+ * Reads the name of the included file from the rest of an include line: the name is written between quotes and only whitespace characters can be after it.
+ * @param rest the characters of the line after the include directive.
+ * @param name the string to copy the name into, it can contain MAX_COMMAND_LEN characters.
+ * @returns true\1 if the name is legal, returns false\0 otherwise.
+*/
+int get_include_name(char *rest, char *name) {
+    char *end;
+    while(is_whitespace(*rest))
+        rest++;
+    if(*rest != '"')
+        return false;
+    rest++;
+    end = strchr(rest, '"');
+    if(end == NULL || end == rest)
+        return false;
+    memcpy(name, rest, end - rest);
+    name[end - rest] = '\0';
+    for(end++; is_whitespace(*end); end++)
+        ;
+    return is_end_null(*end);
+}
+
+/**
+ * Returns the path of an included file: a relative name is found in the directory of the file that includes it, 
+ * so a file can include the files next to it from any working directory.
+ * @param including the path of the file that includes the file, can be NULL.
+ * @param name the name of the included file as it was written in the include.
+ * @returns the path of the included file, it must be freed.
+*/
+char *get_include_path(char *including, char *name) {
+    char *end = including != NULL && name[0] != '/' ? strrchr(including, '/') : NULL; /* the last '/' of the directory of the including file */
+    size_t length = end != NULL ? end - including + 1 : 0; /* the directory is kept with its '/' */
+    char *path = (char*) malloc_and_check(length + strlen(name) + 1);
+    if(length > 0)
+        memcpy(path, including, length);
+    strcpy(&path[length], name);
+    return path;
+}
+
+/**
+ * Expands the lines of a given included file with a new macro table that searches a given prelude after its own macros.
+ * The errors of the file are added with its own name to the diagnostics of a given error location.
+ * @param file a given included file, its text and macros are set.
+ * @param text the text of the file.
+ * @param error_info the error location of the include, its diagnostics are used.
+ * @param prelude the read-only macro table that the file can use the macros of, can be NULL.
+ * @param cache the include cache, the files that the file includes are added into it.
+ * @returns true if the file has errors, returns false otherwise
+*/
+int expand_included_file(included_file *file, char *text, error_location *error_info, macro_table *prelude, include_cache *cache) {
+    text_reader lines;
+    line_reader *reader;
+    output_buffer *writer = create_memory_output_buffer();
+    output_buffer *dependencies = cache->dependencies; /* the names that the file includes are kept with the file */
+    included_file *expanding = cache->expanding; /* the file that includes the file */
+    error_location *file_info = create_empty_error_location(strdup(file->name));
+    int errors;
+    lines.text = text;
+    lines.length = file->size;
+    lines.position = 0;
+    reader = create_block_line_reader(read_text_block, &lines);
+    error_location_set_diagnostics(file_info, error_location_get_diagnostics(error_info));
+    file->macros = create_empty_macro_table();
+    macro_table_set_prelude(file->macros, prelude);
+    cache->dependencies = create_memory_output_buffer();
+    cache->expanding = file;
+    file->expanding = true;
+    errors = pre_assembler_expand_macros(file_info, reader, writer, file->macros, cache);
+    file->expanding = false;
+    cache->expanding = expanding;
+    macro_table_compact(file->macros);
+    file->length = output_buffer_get_length(writer);
+    file->text = (char*) malloc_counted(file->length + 1, MEMORY_MACROS);
+    memcpy(file->text, output_buffer_get_text(writer), file->length);
+    file->lines_count = count_text_lines(file->text, file->length);
+    file->dependencies = (char*) malloc_and_check(output_buffer_get_length(cache->dependencies) + 1);
+    memcpy(file->dependencies, output_buffer_get_text(cache->dependencies), output_buffer_get_length(cache->dependencies));
+    file->dependencies[output_buffer_get_length(cache->dependencies)] = '\0';
+    free_output_buffer(cache->dependencies);
+    cache->dependencies = dependencies;
+    free_output_buffer(writer);
+    free_line_reader(reader);
+    free_error_location(file_info);
+    return errors;
+}
+
+/**
+ * Returns the expanded file of a given name from a given include cache. 
+ * The file is read every time to check its hash, and it is expanded only if it is not in the cache, its text changed or the text of a file it includes changed. 
+ * The old expanded file is marked stale and it is freed when it is not used.
+ * @param cache a given include cache.
+ * @param name the path of the included file, the files are cached by their paths.
+ * @param error_info the error location of the include.
+ * @param prelude the read-only macro table that the file can use the macros of, can be NULL.
+ * @returns the included file, returns NULL if the file can't be opened, includes itself or has errors.
+*/
+included_file *include_cache_get(include_cache *cache, char *name, error_location *error_info, macro_table *prelude) {
+    FILE *input = fopen(name, "r");
+    included_file *file;
+    unsigned long hash;
+    size_t size;
+    char *text;
+    int errors, i;
+    if(input == NULL) {
+        print_error_location(error_info, "the included file \"%s\" can't be opened", name);
+        return NULL;
+    }
+    text = read_text_stream(input, &size);
+    fclose(input);
+    hash = hash_text(HASH_START, text, size);
+    for(file = cache->head; file != NULL && (file->stale != false || strcmp(file->name, name) != 0); file = file->next)
+        ;
+    if(file != NULL && file->expanding != false) {
+        print_error_location(error_info, "the file \"%s\" includes itself", name);
+        free(text);
+        return NULL;
+    }
+    if(file != NULL && file->hash == hash && file->size == size && file->checked_by != cache->current) { /* the file itself was just read */
+        file->checked_by = cache->current;
+        file->unchanged = true;
+        for(i = 0; i < file->includes_count && file->unchanged != false; i++)
+            file->unchanged = included_file_unchanged(cache, file->includes[i]);
+    }
+    if(file != NULL && file->hash == hash && file->size == size && file->unchanged != false) { /* the file is expanded once while its texts do not change */
+        free(text);
+        file->used_by = cache->current;
+        return file;
+    }
+    if(file != NULL) { /* the old file is freed when the files that include it are freed and the current file does not use it */
+        file->stale = true;
+        include_cache_collect(cache);
+    }
+    file = (included_file*) malloc_and_check(sizeof(included_file));
+    file->name = strdup(name);
+    file->hash = hash;
+    file->size = size;
+    file->text = NULL;
+    file->length = 0;
+    file->lines_count = 0;
+    file->dependencies = NULL;
+    file->macros = NULL;
+    file->includes = NULL;
+    file->includes_count = 0;
+    file->includes_size = 0;
+    file->references = 0;
+    file->stale = false;
+    file->used_by = cache->current;
+    file->checked_by = cache->current; /* the text was just read */
+    file->unchanged = true;
+    file->next = cache->head; /* the new file is found before an old text of it */
+    cache->head = file;
+    errors = expand_included_file(file, text, error_info, prelude, cache);
+    free(text);
+    if(errors != false) { /* a file with errors is expanded again by every include so its errors are added every time */
+        remove_included_file(cache, file);
+        print_error_location(error_info, "the included file \"%s\" has errors", name);
+        return NULL;
+    }
+    return file;
+}
+
+/**
+ * Writes the expanded lines of the file that a given include line names into a given output buffer, 
+ * and adds the macros of the file to a given macro table so the lines after the include can use them.
+ * @param error_info the error location of the include line.
+ * @param rest the characters of the line after the include directive.
+ * @param writer the output buffer to write the expanded lines into.
+ * @param macro_table the macro table of the including file.
+ * @param cache the include cache, NULL if files can't be included.
+ * @returns true if the include has errors, returns false otherwise
+*/
+int include_file(error_location *error_info, char *rest, output_buffer *writer, macro_table *macro_table, include_cache *cache) {
+    char name[MAX_COMMAND_LEN+1];
+    char *path;
+    included_file *file;
+    if(cache == NULL) {
+        print_error_location(error_info, "a file can't be included in a prelude");
+        return true;
+    }
+    if(get_include_name(rest, name) == false) {
+        print_error_location(error_info, "the include requires a file name between quotes");
+        return true;
+    }
+    path = get_include_path(error_location_get_file_name(error_info), name); /* the error location is named by the path of the including file */
+    file = include_cache_get(cache, path, error_info, macro_table->prelude);
+    free(path);
+    if(file == NULL)
+        return true;
+    output_buffer_write(writer, file->text, file->length);
+    include_cache_add_source_lines(cache, writer, error_location_get_line(error_info), file->lines_count);
+    macro_table_add_include(macro_table, file->macros);
+    if(cache->expanding != NULL) /* the including file keeps the file while it uses its macros */
+        included_file_add_include(cache->expanding, file);
+    output_buffer_puts(cache->dependencies, " ");
+    output_buffer_puts(cache->dependencies, file->name);
+    output_buffer_puts(cache->dependencies, file->dependencies);
+    return false;
+}
+
+macro_table *load_macro_prelude(char *file_name, diagnostics *diag) {
+    FILE *input = fopen(file_name, "r");
+    macro_table *prelude;
+    output_buffer *writer; /* the lines of the prelude that are not macros */
+    line_reader *reader;
+    error_location *error_info;
+    char *text;
+    size_t i, length;
+    int errors;
+    if(input == NULL) {
+        printf("Error: The prelude %s can't be opened\n", file_name);
+        return NULL;
+    }
+    prelude = create_empty_macro_table();
+    writer = create_memory_output_buffer();
+    error_info = create_empty_error_location(strdup(file_name));
+    error_location_set_diagnostics(error_info, diag);
+    reader = create_line_reader(input);
+    errors = pre_assembler_expand_macros(error_info, reader, writer, prelude, NULL); /* the prelude can't include files */
+    free_line_reader(reader);
+    free_error_location(error_info);
+    fclose(input);
+    text = output_buffer_get_text(writer);
+    length = output_buffer_get_length(writer);
+    for(i = 0; i < length && (is_whitespace(text[i]) || is_end_null(text[i])); i++) /* only empty lines can be left outside of the macros */
+        ;
+    free_output_buffer(writer);
+    if(i < length) {
+        printf("Error: The prelude %s can contain only macro declarations and comments\n", file_name);
+        errors = true;
+    }
+    if(errors != false) {
+        free_macro_table(prelude);
+        return NULL;
+    }
+    macro_table_compact(prelude);
+    return prelude;
+}
+
+int pre_assembler_expand_macros(error_location *error_info, line_reader *reader, output_buffer *writer, macro_table *macro_table, include_cache *cache) {
     /* the size of the 2 string is MAX_COMMAND_LEN + 1 to check if the string fgets is longer than MAX_COMMAND_LEN */
     char command[MAX_COMMAND_LEN+1]; /* the current line */
     char str[MAX_COMMAND_LEN+1]; /* the current argument */
     int flag_mcr_on = false; /* check if a macro was declared */
     int check_mcr_name = false; /* checks if to check o a macro name declaration */
     int line_end = false; /* checks if the line had reached the first or second word and can read the next line */
-    macro_table *macro_table; /* the machine macro table */
-    macro *mcr; /* the current macro */
-    FILE *input; /* the .as file to read */
-    FILE *output; /* the .am file to write */
-    error_location *error_info; /* the error location to print when an error occurs */
+    macro *mcr = NULL; /* the current macro, NULL if the declared macro had an error so its lines are skipped */
     char c;
-    int i;
+    int i = 0;
     int length = 0;
     int error = false; /* check if then current line has macro errors */
     int file_errors = false; /* check if then file has macro errors */
-    input = open_file(file_name, ".as", "r");
-    if(input == NULL) /* check if the .as file had been opened successfully */
-        return true;
-    output = open_file(file_name, ".am", "w");
-    if(output == NULL) { /* check if the .am file had been opened successfully */
-        fclose(input); /* close the .as file to insure safety */
-        return true;
-    }
-    error_info = create_empty_error_location(get_file_full_name(file_name, ".as"));
-    macro_table = create_empty_macro_table();
-    while((fgets(command, MAX_COMMAND_LEN+1, input)) != NULL) {
+    error_location_track_index(error_info, &i); /* the index is read only when an error is printed */
+    while(error_location_limit_reached(error_info) == false && (line_reader_gets(reader, command, MAX_COMMAND_LEN+1)) != NULL) { /* the file is not processed after the maximum number of errors */
         error_location_ascend_line(error_info);
-        error_location_set_index(error_info, 0);
+        i = 0;
         line_end = false;
         check_mcr_name = false;
         error = false;
@@ -70,14 +572,13 @@ int pre_assembler(char *file_name) {
                 print_error_location(error_info, "The line length is bigger than the maximum length of a line in the .am file that is %i", (MAX_COMMAND_LEN));
                 error = true;
             }
-            while((fgets(command, MAX_COMMAND_LEN+1, input)) != NULL) { /* move to the next line or to the end of file (if this is the last line in the file) */
+            while((line_reader_gets(reader, command, MAX_COMMAND_LEN+1)) != NULL) { /* move to the next line or to the end of file (if this is the last line in the file) */
                 if(strchr(command, '\n') != false) /* check if the next fgets will give a new line */
                     break;
             }
         } /* comment lines are ignored */
         else if(command[0] != ';') {
             for(i = 0; i < MAX_COMMAND_LEN && (line_end == false || check_mcr_name == true); i++) { /* read only the first word (non whitespace characters) if check_mcr_name is false otherwise read also the second word */
-                error_location_set_index(error_info, i);
                 c = command[i];
                 if(is_ascii(c) == false) { /* only ascii characters are allowed */
                     print_error_location(error_info, "The character is not asscii");
@@ -98,40 +599,49 @@ int pre_assembler(char *file_name) {
                             print_error_location(error_info, "registers can't be used as a macro name declaration");
                             error = true;
                         }
-                        if(search_in_macro_table(macro_table, str) != NULL) { /* every macro name must be unique */
+                        if(search_in_declared_macros(macro_table, str) != NULL) { /* every macro name must be unique, only a prelude macro can be hidden */
                             print_error_location(error_info, "the macro \"%s\" had already been declared before", str);
+                            mcr = NULL;
                             error = true;
                         }
                         else {
-                            mcr = add_to_macro_table(macro_table, strdup(str));
+                            mcr = add_to_macro_table(macro_table, str);
                             check_mcr_name = false;
                         }
                     }
                     else { /* the first word of the command */
                         macro *head = search_in_macro_table(macro_table, str);
                         if(head != NULL) { /* if str is a macro name then replace it with every line in the macro */
-                            line *lines = get_first_line(head->lines);
-                            while(lines != NULL) {
-                                if(flag_mcr_on != false) /* if the flag_mcr_on is true then copy the current macro lines into the declared macro */
-                                    add_to_line_list(mcr->lines, strdup(lines->line_context));
-                                else /* else puts the line into the .am file */
-                                    fprintf(output, "%s", lines->line_context);                            
-                                lines = lines->next;
+                            if(flag_mcr_on != false) /* if the flag_mcr_on is true then copy the current macro lines into the declared macro */
+                                macro_add_macro_lines(mcr, head);
+                            else { /* else puts the lines into the .am file */
+                                output_buffer_write(writer, head->text, head->length);
+                                include_cache_add_source_lines(cache, writer, error_location_get_line(error_info), head->lines_count);
+                            }
+                        }
+                        else if(strcmp(str, INCLUDE_DIRECTIVE) == 0) { /* the lines of the included file are written instead of the include */
+                            if(flag_mcr_on != false) {
+                                print_error_location(error_info, "a file can't be included inside a macro");
+                                error = true;
                             }
+                            else if(include_file(error_info, &command[i], writer, macro_table, cache) != false)
+                                error = true;
                         }
                         else if(flag_mcr_on != false) { /* if a macro was declared */
                             if(strcmp(str, "endmcr") == 0) /* checks if the macro closes */
                                 flag_mcr_on = false;
                             else /* puts the current line into the macro */
-                                add_to_line_list(mcr->lines, strdup(command));
+                                macro_add_line(mcr, command);
                         }
                         else if(strcmp(str, "mcr") == 0) { /* if the first word is mcr then read the second word */
                                 check_mcr_name = true;
                                 flag_mcr_on = true;
                                 line_end = false;
                             }
-                        else /* puts the crrent line into the .am file */
-                            fprintf(output, "%s", command);                    
+                        else { /* puts the crrent line into the .am file */
+                            output_buffer_puts(writer, command);
+                            include_cache_add_source_lines(cache, writer, error_location_get_line(error_info), 1);
+                        }
                         }
                     length = 0; /* resets the current argument */
                     str[0] = '\0';
@@ -143,115 +653,182 @@ int pre_assembler(char *file_name) {
                 file_errors = true;
             else if(line_end == false) { /* if the line has only whitespace characters or empty */
                 if(flag_mcr_on != false) /* if the flag_mcr is true the add the current line into the macro */
-                    add_to_line_list(mcr->lines, strdup(command));
-                else /* add it into the .am file */
-                    fprintf(output, "%s", command);
+                    macro_add_line(mcr, command);
+                else { /* add it into the .am file */
+                    output_buffer_puts(writer, command);
+                    include_cache_add_source_lines(cache, writer, error_location_get_line(error_info), 1);
+                }
             }
         }
     }
-    fclose(output); /* closes the files to insure safety */
-    fclose(input);
-    free_macro_table(macro_table); /* free the macro table */
-    free_error_location(error_info);
+    error_location_track_index(error_info, NULL);
+    output_buffer_flush(writer);
     return file_errors;
 }
 
 macro_table* create_empty_macro_table() {
-    macro_table *list = (macro_table*) malloc_and_check(sizeof(macro_table));
+    int i;
+    macro_table *list = (macro_table*) malloc_counted(sizeof(macro_table), MEMORY_MACROS);
     list->head = NULL;
     list->root = NULL;
+    list->names = create_intern_pool();
+    list->prelude = NULL;
+    list->includes = NULL;
+    list->includes_count = 0;
+    list->includes_size = 0;
+    list->named_size = MACRO_NAMED_START_SIZE;
+    list->named = (macro**) malloc_counted(sizeof(macro*) * list->named_size, MEMORY_MACROS);
+    for(i = 0; i < list->named_size; i++)
+        list->named[i] = NULL;
     return list;
 }
 
+void macro_table_set_prelude(macro_table *table, macro_table *prelude) {
+    if(table != NULL)
+        table->prelude = prelude;
+}
+
+void macro_table_add_include(macro_table *table, macro_table *included) {
+    if(table == NULL || included == NULL) return;
+    if(table->includes_count == table->includes_size) {
+        table->includes_size = table->includes_size > 0 ? table->includes_size * 2 : MACRO_INCLUDES_START_SIZE;
+        table->includes = (macro_table**) realloc_counted(table->includes, sizeof(macro_table*) * table->includes_size, MEMORY_MACROS);
+    }
+    table->includes[table->includes_count++] = included;
+}
+
+void macro_table_compact(macro_table *table) {
+    macro *mcr;
+    if(table == NULL) return;
+    for(mcr = table->head; mcr != NULL; mcr = mcr->next) /* the text keeps only its used size */
+        if(mcr->text != NULL) {
+            mcr->text_size = mcr->length + 1;
+            mcr->text = (char*) realloc_counted(mcr->text, mcr->text_size, MEMORY_MACROS);
+        }
+}
+
 macro *create_empty_macro() {
-    macro *head = (macro*) malloc_and_check(sizeof(macro));
+    macro *head = (macro*) malloc_counted(sizeof(macro), MEMORY_MACROS);
     head->name = NULL;
-    head->lines = (line_list*) malloc_and_check(sizeof(line_list));
-    head->lines->head = NULL;
-    head->lines->root = NULL;
+    head->text = NULL;
+    head->length = 0;
+    head->text_size = 0;
+    head->lines_count = 0;
     head->next = NULL;
     return head;
 }
 
-line *create_empty_line() {
-    line *head = (line*) malloc_and_check(sizeof(line));
-    head->line_context = NULL;
-    head->next = NULL;
-    return head;
+/**
+ * Makes sure a given macro has room for a given number of additional characters, the text is doubled until it is big enough.
+ * @param mcr a given macro.
+ * @param length the number of characters to add.
+*/
+void macro_reserve(macro *mcr, size_t length) {
+    if(mcr->length + length + 1 > mcr->text_size) { /* the text must fit with '\0' at the end */
+        if(mcr->text_size == 0)
+            mcr->text_size = MACRO_TEXT_START_SIZE;
+        while(mcr->length + length + 1 > mcr->text_size)
+            mcr->text_size *= 2;
+        mcr->text = (char*) realloc_counted(mcr->text, mcr->text_size, MEMORY_MACROS);
+    }
 }
 
-line *add_to_line_list(line_list *list, char str[]) {
-    line *root;
-    if(list == NULL) return NULL;
-    root = create_empty_line();
-    if(list->head == NULL)
-        list->head = root;
-    else if(list->root != NULL)
-        list->root->next = root;
-    root->line_context = str;
-    list->root = root;
-    return root;
+void macro_add_line(macro *mcr, char str[]) {
+    size_t length;
+    if(mcr == NULL) return;
+    length = strlen(str);
+    macro_reserve(mcr, length);
+    mcr->lines_count++;
+    memcpy(&mcr->text[mcr->length], str, length + 1);
+    mcr->length += length;
+}
+
+void macro_add_macro_lines(macro *mcr, macro *src) {
+    size_t length;
+    if(mcr == NULL || src == NULL || src->text == NULL) return;
+    length = src->length; /* the length is saved before reserving because src can be the same macro as mcr */
+    macro_reserve(mcr, length);
+    mcr->lines_count += src->lines_count;
+    memmove(&mcr->text[mcr->length], src->text, length); /* the text of all the lines is copied at once */
+    mcr->length += length;
+    mcr->text[mcr->length] = '\0';
+}
+
+char *macro_get_text(macro *mcr) {
+    return mcr != NULL ? mcr->text : NULL;
+}
+
+size_t macro_get_length(macro *mcr) {
+    return mcr != NULL ? mcr->length : 0;
 }
 
 macro *add_to_macro_table(macro_table *table, char name[]) {
     macro *root;
+    int name_id, i;
     if(table == NULL) return NULL;
     root = create_empty_macro();
     if(table->head == NULL)
         table->head = root;
     else if(table->root != NULL)
         table->root->next = root;
-    root->name = name;
     table->root = root;
+    name_id = intern_pool_add(table->names, name);
+    root->name = intern_pool_get_name(table->names, name_id);
+    if(name_id == INTERN_NONE)
+        return root;
+    if(name_id >= table->named_size) { /* double the named array until the name id fits */
+        i = table->named_size;
+        while(name_id >= table->named_size)
+            table->named_size *= 2;
+        table->named = (macro**) realloc_counted(table->named, sizeof(macro*) * table->named_size, MEMORY_MACROS);
+        for(; i < table->named_size; i++)
+            table->named[i] = NULL;
+    }
+    if(table->named[name_id] == NULL) /* the first occurrence of a name is found first */
+        table->named[name_id] = root;
     return root;
 }
 
-line *get_first_line(line_list *list) {
-    return list != NULL ? list->head : NULL;
-}
-
 macro *get_first_macro(macro_table *table) {
     return table != NULL ? table->head : NULL;
 }
 
 macro *search_in_macro_table(macro_table *table, char name[]) {
-    macro *head;
-    if(table == NULL) return NULL;
-    head = table->head;
-    while(head != NULL) {
-        if(head->name != NULL && strcmp(head->name, name) == 0)
-            return head;
-        head = head->next;
-    }
-    return NULL;
+    macro *mcr = search_in_declared_macros(table, name);
+    if(mcr != NULL || table == NULL)
+        return mcr;
+    return search_in_macro_table(table->prelude, name); /* the prelude is searched only after the table and the included tables */
 }
 
-void free_line(line *head) {
-    line *root;
-    if(head == NULL) return;
-    root = head->next;
-    free(head->line_context);
-    free(head);
-    free_line(root);
+macro *search_in_declared_macros(macro_table *table, char name[]) {
+    int name_id, i;
+    macro *mcr;
+    if(table == NULL) return NULL;
+    name_id = intern_pool_find(table->names, name);
+    if(name_id != INTERN_NONE)
+        return table->named[name_id];
+    for(i = 0; i < table->includes_count; i++) /* the included tables are searched in the order of the includes */
+        if((mcr = search_in_declared_macros(table->includes[i], name)) != NULL)
+            return mcr;
+    return NULL;
 }
 
 void free_macro(macro *head) {
     macro *root;
     if(head == NULL) return;
     root = head->next;
-    free(head->name);
-    if(head->lines != NULL) {
-        free_line(head->lines->head);
-        free(head->lines);
-    }
-    free(head);
+    free_counted(head->text);
+    free_counted(head);
     free_macro(root);
 }
 
 void free_macro_table(macro_table *table) {
     if(table == NULL) return;
     free_macro(table->head);
-    free(table);
+    free_counted(table->named);
+    free_counted(table->includes);
+    free_intern_pool(table->names);
+    free_counted(table);
 }
 
 int is_macro_opcode(char str[]) {
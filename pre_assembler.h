@@ -1,20 +1,18 @@
 #ifndef PRE_ASSEMBLER_H
 #define PRE_ASSEMBLER_H
 
-/**
- * A data structure used for storing lines from a given file. 
- * Also the structure is linked (linked list).
-*/
-typedef struct line_t line;
+#include "utils.h"
 
-/**
- * A data structure that is used for storing linked lines with a constant insertion time.
-*/
-typedef struct line_list_t line_list;
+#define MACRO_TEXT_START_SIZE 256 /* the first size of a macro text, it is doubled every time the text is full */
+#define PRE_ASSEMBLER_NO_FILE -1 /* returned by the pre assembler when the .as or .am file could not be opened, then the next steps can't run */
+#define MACRO_NAMED_START_SIZE 16 /* the number of name ids a new macro table can search before its array is doubled */
+#define MACRO_INCLUDES_START_SIZE 4 /* the first number of included tables a macro table can search, it is doubled every time the array is full */
+#define INCLUDE_DIRECTIVE ".include" /* the first word of a line that includes a file: .include "file name" */
+#define SOURCE_LINES_START_SIZE 1024 /* the first number of expanded lines an include cache can map to their source lines, it is doubled every time the array is full */
 
 /**
  * A data structure used for macros from a given file: 
- * the macro name and lines.
+ * the macro name and lines, the lines are stored one after the other in a single text.
  * Also the structure is linked (linked list).
 */
 typedef struct macro_t macro;
@@ -25,11 +23,116 @@ typedef struct macro_t macro;
 typedef struct macro_table_t macro_table;
 
 /**
- * Process the macro declarations of the .as file and creates a .am file if there were no errors in the file. 
+ * A data structure used for the files that were included during a run: every included file is read and expanded once 
+ * and its lines and macros are shared by every file that includes it, while the hash of its text does not change. 
+ * It also collects the names of the files that the current file included for its dependency file, 
+ * and the source line of every expanded line of the current file for its listing file. 
+ * It is not thread-safe, so it is used by one pre assembler at a time.
+*/
+typedef struct include_cache_t include_cache;
+
+/**
+ * Process the macro declarations and the includes of the .as file and creates a .am file, the lines with macro errors are not written into the .am file. 
+ * The .as file is read in blocks and the .am file is written in blocks, therefore only the macros and the included files are kept in memory.
  * @param file_name the file name
+ * @param diag the diagnostics to add the errors into, if NULL then the errors are printed
+ * @param prelude the read-only macro table that the file can use the macros of, can be NULL
+ * @param cache the include cache to share the included files with, if NULL then the included files are kept only for this file
+ * @returns true if the file has errors, returns PRE_ASSEMBLER_NO_FILE if the .as or .am file could not be opened, returns false otherwise
+*/
+int pre_assembler(char *file_name, diagnostics *diag, macro_table *prelude, include_cache *cache);
+
+/**
+ * Process the macro declarations and the includes of a given opened .as file and writes the expanded lines into a given output buffer. 
+ * The macros of the file are kept in a new macro table that searches a given prelude after its own macros, so the prelude is not copied or changed. 
+ * A macro of the file can have the name of a prelude macro, then the lines after its declaration use the macro of the file.
+ * At the end the output buffer is flushed. If the diagnostics reach their maximum number of errors then the rest of the file is not processed.
+ * If the cache writes dependency files then the .d file of the file is written.
+ * @param file_name the file name, used for the error locations.
+ * @param input the .as file to read.
+ * @param writer the output buffer to write the expanded lines into.
+ * @param diag the diagnostics to add the errors into, if NULL then the errors are printed.
+ * @param prelude the read-only macro table that the file can use the macros of, can be NULL.
+ * @param cache the include cache to share the included files with, if NULL then the included files are kept only for this file.
  * @returns true if the file has errors, returns false otherwise
 */
-int pre_assembler(char *file_name);
+int pre_assembler_expand(char *file_name, FILE *input, output_buffer *writer, diagnostics *diag, macro_table *prelude, include_cache *cache);
+
+/**
+ * Process the macro declarations and the includes of the lines of a given line reader with a given macro table, the new macros are added to the table. 
+ * An include line (.include "file name") is replaced with the expanded lines of the file, and the macros of the file can be used after it. 
+ * A relative file name is found in the directory of the file that includes it. 
+ * An included file is expanded on its own: it can use only its own macros, the macros of the files it includes and the prelude.
+ * Writes the expanded lines into a given output buffer and flushes it at the end.
+ * @param error_info the error location to print the errors with.
+ * @param reader the line reader to read the lines from.
+ * @param writer the output buffer to write the expanded lines into.
+ * @param macro_table the macro table to search and add the macros.
+ * @param cache the include cache of the included files, NULL for a prelude that can't include files.
+ * @returns true if the file has errors, returns false otherwise
+*/
+int pre_assembler_expand_macros(error_location *error_info, line_reader *reader, output_buffer *writer, macro_table *macro_table, include_cache *cache);
+
+/**
+ * Creates an empty include cache that does not write dependency files.
+ * @returns the newly created include cache.
+*/
+include_cache *create_include_cache();
+
+/**
+ * Sets if the pre assembler writes the Make dependency file (.d) of every file that is expanded with a given include cache: 
+ * "file.am file.ob: file.as" followed by every file that it included.
+ * @param cache a given include cache.
+ * @param status true\1 to write the dependency files, false\0 otherwise.
+*/
+void include_cache_set_dependencies(include_cache *cache, int status);
+
+/**
+ * Sets if the pre assembler keeps the source line of every expanded line of every file that is expanded with a given include cache, 
+ * the lines of a macro and of an included file are mapped to the line that used the macro or included the file.
+ * @param cache a given include cache.
+ * @param status true\1 to keep the source lines, false\0 otherwise.
+*/
+void include_cache_set_source_lines(include_cache *cache, int status);
+
+/**
+ * Returns the line of the .as file that a given line of the .am file of the last expanded file was written for.
+ * @param cache a given include cache that keeps the source lines.
+ * @param line a given line number of the .am file, starting from 1.
+ * @returns the line number of the .as file, returns 0 if the source lines were not kept or the line does not exist.
+*/
+int include_cache_get_source_line(include_cache *cache, int line);
+
+/**
+ * Returns the names of the files that the last file expanded with a given include cache included, directly or through other files.
+ * @param cache a given include cache.
+ * @param length a pointer to store the number of characters of the names.
+ * @returns the names, every name after a space, the text does not end with a null character.
+*/
+char *include_cache_get_dependencies(include_cache *cache, size_t *length);
+
+/**
+ * Marks every file of a given include cache as stale, so every include expands its file again. 
+ * Used when the prelude that the files were expanded with is replaced, the old files are freed when they are not used.
+ * @param cache a given include cache.
+*/
+void include_cache_clear(include_cache *cache);
+
+/**
+ * Free the memory a given include cache contains from the system memory, with the lines and macros of every included file.
+ * @param cache a given include cache.
+*/
+void free_include_cache(include_cache *cache);
+
+/**
+ * Reads the macro declarations of a given prelude file into a new compact macro table, 
+ * the table is used read-only as the prelude of every file so it can be shared by every file and thread.
+ * The prelude can contain only macro declarations, comments and empty lines.
+ * @param file_name the full name of the prelude file.
+ * @param diag the diagnostics to add the errors into, if NULL then the errors are printed.
+ * @returns the newly created macro table, returns NULL if the file can't be opened or has errors.
+*/
+macro_table *load_macro_prelude(char *file_name, diagnostics *diag);
 
 /**
  * Creates an empty macro table.
@@ -37,6 +140,27 @@ int pre_assembler(char *file_name);
 */
 macro_table* create_empty_macro_table();
 
+/**
+ * Sets the prelude of a given macro table: a read-only macro table that is searched after the macros of the table.
+ * @param table a given macro table.
+ * @param prelude a given macro table, can be NULL.
+*/
+void macro_table_set_prelude(macro_table *table, macro_table *prelude);
+
+/**
+ * Adds a given read-only macro table of an included file to the tables that a given macro table searches after its own macros and before its prelude.
+ * @param table a given macro table.
+ * @param included a given macro table, it is not freed with the table.
+*/
+void macro_table_add_include(macro_table *table, macro_table *included);
+
+/**
+ * Shrinks the text of every macro of a given macro table to their used size, 
+ * used for tables that will not get new lines.
+ * @param table a given macro table.
+*/
+void macro_table_compact(macro_table *table);
+
 /**
  * Creates an empty macro.
  * @returns the newly created macro.
@@ -44,36 +168,42 @@ macro_table* create_empty_macro_table();
 macro* create_empty_macro();
 
 /**
- * Creates an empty line.
- * @returns the newly created line.
+ * Adds a copy of a given line to the end of a given macro text.
+ * @param mcr a given macro.
+ * @param str a given line.
+*/
+void macro_add_line(macro *mcr, char str[]);
+
+/**
+ * Adds a copy of every line of a given macro to the end of another given macro.
+ * @param mcr a given macro to add the lines to.
+ * @param src a given macro to copy the lines from.
 */
-line *create_empty_line();
+void macro_add_macro_lines(macro *mcr, macro *src);
 
 /**
- * Creates an empty line and sets its line context to a given string.
- * After that inserts the newly created line to the end of a given line list and returns the new line.
- * @param line a given line list.
- * @param str a given string.
- * @returns the newly created line, returns NULL if failed to create.
+ * Returns the text of a given macro: every line of the macro one after the other.
+ * @param mcr a given macro.
+ * @returns the text of the macro, if the macro is NULL then returns NULL.
 */
-line *add_to_line_list(line_list *list, char str[]);
+char *macro_get_text(macro *mcr);
 
 /**
- * Creates an empty macro and sets its name to a given name.
- * After that inserts the newly created macro to the end of a given macro table and returns the new macro.
+ * Returns the number of characters the text of a given macro contains.
+ * @param mcr a given macro.
+ * @returns the length of the macro text, if the macro is NULL then returns 0.
+*/
+size_t macro_get_length(macro *mcr);
+
+/**
+ * Creates an empty macro and sets its name to a given name, the name is copied into the intern pool of a given macro table.
+ * After that inserts the newly created macro to the end of the macro table and returns the new macro.
  * @param table a given macro table.
  * @param name a given name.
  * @returns the newly created macro, returns NULL if failed to create.
 */
 macro *add_to_macro_table(macro_table *table, char name[]);
 
-/**
- * Returns the first line of a line list.
- * @param list a given line list.
- * @returns the first line of the line list.
-*/
-line *get_first_line(line_list *list);
-
 /**
  * Returns the first macro of a macro table.
  * @param table a given macro table.
@@ -83,7 +213,7 @@ macro *get_first_macro(macro_table *table);
 
 /**
  * Searches a given macro table to find a macro that its name equals to a given name. 
- * If this macro exists then return the first occurrence in the macro table.
+ * If this macro exists then return the first occurrence in the macro table, otherwise the included tables and then the prelude of the table are searched.
  * @param table a given macro table.
  * @param name a given name.
  * @returns the macro that its name equals to a given name, if not exists then returns NULL.
@@ -91,10 +221,13 @@ macro *get_first_macro(macro_table *table);
 macro *search_in_macro_table(macro_table *table, char name[]);
 
 /**
- * Free the memory a given line contains from the system memory.
- * @param head a given line.
+ * Searches a given macro table and the included tables to find a macro that its name equals to a given name, without searching the prelude of the table. 
+ * Used to check that a new macro name is unique, the macros of the prelude can be hidden by the macros of a file.
+ * @param table a given macro table.
+ * @param name a given name.
+ * @returns the macro that its name equals to a given name, if not exists then returns NULL.
 */
-void free_line(line *head);
+macro *search_in_declared_macros(macro_table *table, char name[]);
 
 /**
  * Free the memory a given macro contains from the system memory.
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "utils.h"
+
+/**
+ * Splits a given request line into its words, the whitespace characters after every word are replaced with end null characters.
+ * @param request a given request line.
+ * @param words the array to insert the words into, it can contain SERVER_MAX_WORDS words.
+ * @returns the number of words, returns -1 if the request has more than SERVER_MAX_WORDS words.
+*/
+int split_request(char *request, char **words) {
+    int count = 0;
+    char *word = strtok(request, " \t\r\n");
+    while(word != NULL) {
+        if(count == SERVER_MAX_WORDS)
+            return -1;
+        words[count++] = word;
+        word = strtok(NULL, " \t\r\n");
+    }
+    return count;
+}
+
+/**
+ * Copies a given number of characters from a given input into the .as file of a given file name.
+ * The characters are read from the input even if the file can't be opened, so the next request starts after them.
+ * @param input the input to read the source from.
+ * @param file_name a given file name without extension.
+ * @param length the number of characters of the source.
+ * @returns true\1 if the source was written, returns false\0 otherwise.
+*/
+int server_write_source(FILE *input, char *file_name, long length) {
+    char block[INPUT_BLOCK_SIZE]; /* the source is copied in blocks */
+    size_t count;
+    int written = true;
+    FILE *file = open_file(file_name, ".as", "w");
+    if(file == NULL)
+        written = false;
+    while(length > 0) {
+        count = fread(block, 1, length < INPUT_BLOCK_SIZE ? (size_t) length : INPUT_BLOCK_SIZE, input);
+        if(count == 0) {
+            printf("Error: the input ended before the source of %s ended\n", file_name);
+            written = false;
+            break;
+        }
+        if(file != NULL)
+            fwrite(block, 1, count, file);
+        length -= count;
+    }
+    if(file != NULL)
+        fclose(file);
+    return written;
+}
+
+/**
+ * Assembles a given file with given options and writes its errors and its status line.
+ * @param machine the machine that assembles the file.
+ * @param options the options of the request.
+ * @param file_name a given file name without extension.
+ * @returns false\0 if an error occurs, returns true\1 otherwise.
+*/
+int server_assemble(machine *machine, assembler_options *options, char *file_name) {
+    int assembled = assemble_with_options(machine, options, file_name);
+    diagnostics_flush(machine_get_diagnostics(machine), stdout);
+    printf("status %s %s\n", file_name, assembled != false ? "assembled" : "failed");
+    return assembled;
+}
+
+void run_server(machine *machine, assembler_options *defaults, FILE *input) {
+    char request[SERVER_REQUEST_SIZE]; /* the current request line */
+    char *words[SERVER_MAX_WORDS]; /* the words of the current request */
+    assembler_options options; /* the options of the current request */
+    int count, i, used;
+    long length;
+    char *end;
+    while(fgets(request, SERVER_REQUEST_SIZE, input) != NULL) {
+        if(strchr(request, '\n') == NULL && feof(input) == 0) { /* the rest of a long request is skipped */
+            printf("Error: a request can't be longer than %i characters\n", SERVER_REQUEST_SIZE - 2);
+            while(fgets(request, SERVER_REQUEST_SIZE, input) != NULL && strchr(request, '\n') == NULL)
+                ;
+            printf("end\n");
+            fflush(stdout);
+            continue;
+        }
+        count = split_request(request, words);
+        if(count == 0) /* empty lines are ignored */
+            continue;
+        if(count > 0 && strcmp(words[0], "quit") == 0)
+            break;
+        options = *defaults;
+        options.simulate = false; /* the options that only the command line can set */
+        options.server = false;
+        options.watch = false;
+        options.prelude = NULL;
+        for(i = 1; i < count && (used = parse_option(&options, count, words, i)) > 0; i += used)
+            ;
+        apply_options(machine, &options);
+        if(count < 0)
+            printf("Error: a request can't contain more than %i words\n", SERVER_MAX_WORDS);
+        else if(options.simulate != false || options.server != false || options.watch != false || options.prelude != NULL)
+            printf("Error: the options --simulate, --server, --watch and --prelude can't be used in a request\n");
+        else if(strcmp(words[0], "assemble") == 0) {
+            if(i == count)
+                printf("Error: the request assemble requires file names\n");
+            for(; i < count; i++)
+                if(server_assemble(machine, &options, words[i]) == false && options.fail_fast != false) /* a failed file stops the request with --fail-fast */
+                    break;
+        }
+        else if(strcmp(words[0], "source") == 0) {
+            length = i + 2 == count ? strtol(words[i + 1], &end, 10) : -1;
+            if(length < 0 || *end != '\0')
+                printf("Error: the request source requires a file name and the length of its source\n");
+            else if(server_write_source(input, words[i], length) != false)
+                server_assemble(machine, &options, words[i]);
+        }
+        else
+            printf("Error: the request %s is unknown, the requests are assemble, source and quit\n", words[0]);
+        printf("end\n");
+        fflush(stdout);
+    }
+}
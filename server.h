@@ -0,0 +1,24 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "options.h"
+
+#define SERVER_REQUEST_SIZE 4096 /* the maximum length of a request line including the new line and end null characters */
+#define SERVER_MAX_WORDS 256 /* the maximum number of words a request contains */
+
+/**
+ * Runs the assembler as a server that reads requests from a given input and writes the responses to the standard output,
+ * so a build system keeps one process and one machine for many files instead of starting the program for every file.
+ * Every request is a single line of words separated by whitespace, the options of a request are given after its name and apply only to it:
+ * "assemble [options] FILE..." assembles the files FILE.as,
+ * "source [options] FILE LENGTH" is followed by exactly LENGTH characters that are written into FILE.as and then assembled,
+ * "quit" stops the server, the server also stops at the end of the input.
+ * For every file the response contains its errors in the format of the options and then the line "status FILE assembled" or "status FILE failed",
+ * and every response ends with the line "end". The output is flushed after every response.
+ * @param machine the machine that assembles every file.
+ * @param defaults the options of the requests that don't set them.
+ * @param input the input to read the requests from.
+*/
+void run_server(machine *machine, assembler_options *defaults, FILE *input);
+
+#endif
@@ -0,0 +1,515 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simulator.h"
+#include "assembler.h"
+
+#define SIM_FIELD_MASK 0xFFF /* the 12 bits of a word that hold an integer or an address */
+#define SIM_REGISTER_MASK 0x3F /* the 6 bits of a word that hold a register number */
+#define SIM_WORD_MASK 0x3FFF /* the 14 bits of a machine word */
+
+typedef struct sim_instruction_t sim_instruction;
+
+/**
+ * A handler that executes a predecoded instruction and returns the next instruction to execute,
+ * returns NULL when the simulation needs to stop.
+*/
+typedef sim_instruction *(*sim_handler)(simulator *sim, sim_instruction *instrct);
+
+/**
+ * A data structure used for storing a decoded operand: its addressing mode and its value,
+ * the value is the integer for ADDRESSING_IMMEDIATE, the memory address for ADDRESSING_DIRECT and the register number for ADDRESSING_REGISTER.
+*/
+typedef struct sim_operand
+{
+    ADDRESSING_MODE mode; /* the addressing mode of the operand */
+    int value; /* the integer, address or register number of the operand */
+} sim_operand;
+
+struct sim_instruction_t
+{
+    sim_handler execute; /* the handler of the instruction opcode */
+    OPCODE_TYPE opcode; /* the opcode type of the instruction */
+    sim_operand source; /* the source operand, or the first parameter when the instruction uses parameter addressing */
+    sim_operand destination; /* the destination operand, or the second parameter when the instruction uses parameter addressing */
+    int address; /* the memory address of the instruction first word */
+    int target; /* the jump address of jmp, bne and jsr */
+    unsigned has_parameters:1; /* set true\1 if the instruction uses parameter addressing */
+    unsigned is_extern:1; /* set true\1 if one of the instruction words is an extern word that the simulator can't resolve */
+    sim_instruction *next; /* the instruction that starts after the last word of this instruction */
+    sim_instruction *jump; /* the instruction at the jump target, NULL if the target is not an instruction */
+};
+
+struct simulator_t
+{
+    int memory[SIM_MEMORY_SIZE]; /* the memory words of the program, code and data */
+    int registers[MAX_REGISTERS]; /* the registers r0 to r7 */
+    unsigned zero_flag:1; /* set true\1 if the last arithmetic result was 0 */
+    int stack[SIM_STACK_SIZE]; /* the return addresses of jsr */
+    int stack_size; /* the number of return addresses inside the stack */
+    int code_start; /* the address of the first instruction */
+    int code_length; /* the number of code words */
+    sim_instruction *instructions; /* the predecoded instructions in the order they appear in memory */
+    int instructions_count; /* the number of predecoded instructions */
+    sim_instruction **decoded; /* maps every code word (from code_start) to the instruction that starts on it, NULL if no instruction starts on it */
+    SIMULATION_STATUS status; /* the reason the last run stopped */
+    long steps; /* the number of instructions executed in the last run */
+    double seconds; /* the processor time of the last run */
+};
+
+/**
+ * Converts a given integer to a signed 14 bit machine value.
+ * @param value a given integer.
+ * @returns the value that a machine word holds for the integer.
+*/
+int sim_word_value(int value) {
+    value &= SIM_WORD_MASK;
+    return value >= (1 << (WORD_BIT - 1)) ? value - (1 << WORD_BIT) : value;
+}
+
+/**
+ * Converts the 12 bits integer field of a machine word to a signed integer.
+ * @param word a given machine word.
+ * @returns the signed integer inside the word.
+*/
+int sim_word_field(int word) {
+    int value = (word >> 2) & SIM_FIELD_MASK;
+    return value >= (1 << (INT_BIT - 1)) ? value - (1 << INT_BIT) : value;
+}
+
+/**
+ * Stops the simulation with a fault and prints the reason.
+ * @param sim a given simulator.
+ * @param instrct the instruction that caused the fault.
+ * @param message a given error message.
+ * @returns NULL so handlers can return the call.
+*/
+sim_instruction *sim_fault(simulator *sim, sim_instruction *instrct, char *message) {
+    printf("Error: simulation fault at address %i: %s\n", instrct->address, message);
+    sim->status = SIMULATION_FAULT;
+    return NULL;
+}
+
+/**
+ * Returns a pointer to the memory word or register that a given operand points to.
+ * @param sim a given simulator.
+ * @param operand a given operand.
+ * @returns the pointer of the operand location, returns NULL for immediate operands or addresses outside the memory.
+*/
+int *sim_operand_location(simulator *sim, sim_operand *operand) {
+    if(operand->mode == ADDRESSING_REGISTER)
+        return &sim->registers[operand->value];
+    if(operand->mode == ADDRESSING_DIRECT && operand->value >= 0 && operand->value < SIM_MEMORY_SIZE)
+        return &sim->memory[operand->value];
+    return NULL;
+}
+
+/**
+ * Reads the value of a given operand into a given integer pointer.
+ * @param sim a given simulator.
+ * @param operand a given operand.
+ * @param value a pointer to store the operand value.
+ * @returns true\1 if the operand was read, returns false\0 otherwise.
+*/
+int sim_read(simulator *sim, sim_operand *operand, int *value) {
+    int *location;
+    if(operand->mode == ADDRESSING_IMMEDIATE) {
+        *value = operand->value;
+        return true;
+    }
+    location = sim_operand_location(sim, operand);
+    if(location == NULL)
+        return false;
+    *value = *location;
+    return true;
+}
+
+/**
+ * Writes a given value into the location of a given operand.
+ * @param sim a given simulator.
+ * @param operand a given operand.
+ * @param value a given value.
+ * @returns true\1 if the operand was written, returns false\0 otherwise.
+*/
+int sim_write(simulator *sim, sim_operand *operand, int value) {
+    int *location = sim_operand_location(sim, operand);
+    if(location == NULL)
+        return false;
+    *location = sim_word_value(value);
+    return true;
+}
+
+/**
+ * Executes the two operands arithmetic opcodes: mov, cmp, add and sub.
+*/
+sim_instruction *sim_execute_two_operands(simulator *sim, sim_instruction *instrct) {
+    int source, destination;
+    if(sim_read(sim, &instrct->source, &source) == false || sim_read(sim, &instrct->destination, &destination) == false)
+        return sim_fault(sim, instrct, "illegal operand address");
+    if(instrct->opcode == MOV)
+        destination = source;
+    else if(instrct->opcode == ADD)
+        destination = sim_word_value(destination + source);
+    else if(instrct->opcode == SUB)
+        destination = sim_word_value(destination - source);
+    else { /* cmp only sets the zero flag */
+        sim->zero_flag = sim_word_value(source - destination) == 0;
+        return instrct->next;
+    }
+    if(instrct->opcode != MOV)
+        sim->zero_flag = destination == 0;
+    if(sim_write(sim, &instrct->destination, destination) == false)
+        return sim_fault(sim, instrct, "illegal destination operand");
+    return instrct->next;
+}
+
+/**
+ * Executes the lea opcode: the destination receives the address of the source label.
+*/
+sim_instruction *sim_execute_lea(simulator *sim, sim_instruction *instrct) {
+    if(sim_write(sim, &instrct->destination, instrct->source.value) == false)
+        return sim_fault(sim, instrct, "illegal destination operand");
+    return instrct->next;
+}
+
+/**
+ * Executes the one operand arithmetic opcodes: not, clr, inc and dec.
+*/
+sim_instruction *sim_execute_one_operand(simulator *sim, sim_instruction *instrct) {
+    int value;
+    if(sim_read(sim, &instrct->destination, &value) == false)
+        return sim_fault(sim, instrct, "illegal operand address");
+    if(instrct->opcode == NOT)
+        value = sim_word_value(~value);
+    else if(instrct->opcode == CLR)
+        value = 0;
+    else if(instrct->opcode == INC)
+        value = sim_word_value(value + 1);
+    else
+        value = sim_word_value(value - 1);
+    sim->zero_flag = value == 0;
+    if(sim_write(sim, &instrct->destination, value) == false)
+        return sim_fault(sim, instrct, "illegal destination operand");
+    return instrct->next;
+}
+
+/**
+ * Executes the red opcode: reads a character from the standard input.
+*/
+sim_instruction *sim_execute_red(simulator *sim, sim_instruction *instrct) {
+    if(sim_write(sim, &instrct->destination, getchar()) == false)
+        return sim_fault(sim, instrct, "illegal destination operand");
+    return instrct->next;
+}
+
+/**
+ * Executes the prn opcode: prints the value of the operand.
+*/
+sim_instruction *sim_execute_prn(simulator *sim, sim_instruction *instrct) {
+    int value;
+    if(sim_read(sim, &instrct->destination, &value) == false)
+        return sim_fault(sim, instrct, "illegal operand address");
+    printf("%i\n", value);
+    return instrct->next;
+}
+
+/**
+ * Executes the jump opcodes: jmp, bne and jsr, and copies the parameters to r6 and r7 when the instruction uses parameter addressing.
+*/
+sim_instruction *sim_execute_jump(simulator *sim, sim_instruction *instrct) {
+    int first, second;
+    if(instrct->opcode == BNE && sim->zero_flag)
+        return instrct->next;
+    if(instrct->is_extern)
+        return sim_fault(sim, instrct, "can't jump to an extern label");
+    if(instrct->jump == NULL)
+        return sim_fault(sim, instrct, "the jump target is not an instruction");
+    if(instrct->has_parameters) {
+        if(sim_read(sim, &instrct->source, &first) == false || sim_read(sim, &instrct->destination, &second) == false)
+            return sim_fault(sim, instrct, "illegal parameter address");
+        sim->registers[MAX_REGISTERS-2] = first;
+        sim->registers[MAX_REGISTERS-1] = second;
+    }
+    if(instrct->opcode == JSR) {
+        if(sim->stack_size >= SIM_STACK_SIZE)
+            return sim_fault(sim, instrct, "the return stack is full");
+        sim->stack[sim->stack_size++] = instrct->address;
+    }
+    return instrct->jump;
+}
+
+/**
+ * Executes the rts opcode: returns to the instruction after the last jsr.
+*/
+sim_instruction *sim_execute_rts(simulator *sim, sim_instruction *instrct) {
+    if(sim->stack_size == 0)
+        return sim_fault(sim, instrct, "rts without jsr");
+    return sim->decoded[sim->stack[--sim->stack_size] - sim->code_start]->next;
+}
+
+/**
+ * Executes the stop opcode.
+*/
+sim_instruction *sim_execute_stop(simulator *sim, sim_instruction *instrct) {
+    sim->status = SIMULATION_STOPPED;
+    return NULL;
+}
+
+/**
+ * Executes an instruction that uses an extern word as an operand.
+*/
+sim_instruction *sim_execute_extern(simulator *sim, sim_instruction *instrct) {
+    return sim_fault(sim, instrct, "extern labels can't be simulated");
+}
+
+/**
+ * Returns the handler that executes a given opcode type.
+ * @param opcode a given opcode type.
+ * @returns the handler of the opcode type.
+*/
+sim_handler sim_get_handler(OPCODE_TYPE opcode) {
+    if(opcode == MOV || opcode == CMP || opcode == ADD || opcode == SUB)
+        return sim_execute_two_operands;
+    if(opcode == LEA)
+        return sim_execute_lea;
+    if(opcode == NOT || opcode == CLR || opcode == INC || opcode == DEC)
+        return sim_execute_one_operand;
+    if(opcode == RED)
+        return sim_execute_red;
+    if(opcode == PRN)
+        return sim_execute_prn;
+    if(is_opcode_parameter_addresing(opcode))
+        return sim_execute_jump;
+    if(opcode == RTS)
+        return sim_execute_rts;
+    return sim_execute_stop;
+}
+
+/**
+ * Decodes an operand word of a given addressing mode into a given operand.
+ * @param operand a given operand.
+ * @param mode the addressing mode of the operand.
+ * @param word the machine word of the operand.
+ * @param is_source true\1 if the register number is in the source register bits of the word.
+ * @returns true\1 if the word is an extern word, returns false\0 otherwise.
+*/
+int sim_decode_operand(sim_operand *operand, ADDRESSING_MODE mode, int word, int is_source) {
+    operand->mode = mode;
+    if(mode == ADDRESSING_REGISTER)
+        operand->value = (word >> (is_source ? 8 : 2)) & SIM_REGISTER_MASK;
+    else if(mode == ADDRESSING_DIRECT)
+        operand->value = (word >> 2) & SIM_FIELD_MASK;
+    else
+        operand->value = sim_word_field(word);
+    return mode == ADDRESSING_DIRECT && (word & 3) == ENCODING_E;
+}
+
+/**
+ * Decodes the operands words of an instruction with 2 operands or 2 parameters, starting at a given address.
+ * @param sim a given simulator.
+ * @param instrct a given instruction, the operands addressing modes are already set.
+ * @param address the address of the first operand word.
+ * @returns the address after the last operand word, returns -1 if the code ends before the last operand word.
+*/
+int sim_decode_operands(simulator *sim, sim_instruction *instrct, int address) {
+    ADDRESSING_MODE source = instrct->source.mode, destination = instrct->destination.mode;
+    if(address >= sim->code_start + sim->code_length)
+        return -1;
+    if(source == ADDRESSING_REGISTER && destination == ADDRESSING_REGISTER) { /* 2 registers share the same word */
+        sim_decode_operand(&instrct->source, source, sim->memory[address], true);
+        sim_decode_operand(&instrct->destination, destination, sim->memory[address], false);
+        return address + 1;
+    }
+    if(address + 1 >= sim->code_start + sim->code_length)
+        return -1;
+    if(sim_decode_operand(&instrct->source, source, sim->memory[address], true))
+        instrct->is_extern = true;
+    if(sim_decode_operand(&instrct->destination, destination, sim->memory[address+1], false))
+        instrct->is_extern = true;
+    return address + 2;
+}
+
+/**
+ * Decodes the instruction that starts on a given address into a given predecoded instruction.
+ * @param sim a given simulator.
+ * @param instrct the predecoded instruction to fill.
+ * @param address the address of the instruction first word.
+ * @returns the address after the last word of the instruction, returns -1 if the words are not a legal instruction.
+*/
+int sim_decode_instruction(simulator *sim, sim_instruction *instrct, int address) {
+    int word = sim->memory[address];
+    int code_end = sim->code_start + sim->code_length;
+    ADDRESSING_MODE destination = (word >> 2) & 3;
+    instrct->address = address;
+    instrct->opcode = (word >> 6) & 15;
+    instrct->source.mode = (word >> 4) & 3;
+    instrct->source.value = 0;
+    instrct->destination.mode = destination;
+    instrct->destination.value = 0;
+    instrct->target = 0;
+    instrct->has_parameters = false;
+    instrct->is_extern = false;
+    instrct->next = NULL;
+    instrct->jump = NULL;
+    instrct->execute = sim_get_handler(instrct->opcode);
+    if((word & 3) != ENCODING_A) /* the first word of an instruction is always absolute */
+        return -1;
+    address++;
+    if(is_opcode_group_three(instrct->opcode))
+        return address;
+    if(address >= code_end)
+        return -1;
+    if(is_opcode_parameter_addresing(instrct->opcode)) {
+        instrct->target = (sim->memory[address] >> 2) & SIM_FIELD_MASK;
+        instrct->is_extern = (sim->memory[address] & 3) == ENCODING_E;
+        address++;
+        if(destination == ADDRESSING_PARAMATER) {
+            instrct->has_parameters = true;
+            instrct->source.mode = (word >> 12) & 3;
+            instrct->destination.mode = (word >> 10) & 3;
+            address = sim_decode_operands(sim, instrct, address);
+        }
+    }
+    else if(is_opcode_group_one(instrct->opcode))
+        address = sim_decode_operands(sim, instrct, address);
+    else if(sim_decode_operand(&instrct->destination, destination, sim->memory[address++], false))
+        instrct->is_extern = true;
+    if(instrct->is_extern && is_opcode_parameter_addresing(instrct->opcode) == false)
+        instrct->execute = sim_execute_extern;
+    return address;
+}
+
+/**
+ * Predecodes every instruction of the loaded program code and links each instruction to the next instruction and to its jump target.
+ * @param sim a given simulator.
+ * @returns true\1 if the code was decoded successfully, returns false\0 otherwise.
+*/
+int sim_predecode(simulator *sim) {
+    int address = sim->code_start, next, i;
+    int code_end = sim->code_start + sim->code_length;
+    sim->instructions = (sim_instruction*) malloc_and_check(sizeof(sim_instruction) * (sim->code_length + 1));
+    sim->decoded = (sim_instruction**) malloc_and_check(sizeof(sim_instruction*) * (sim->code_length + 1));
+    for(i = 0; i <= sim->code_length; i++)
+        sim->decoded[i] = NULL;
+    sim->instructions_count = 0;
+    while(address < code_end) {
+        next = sim_decode_instruction(sim, &sim->instructions[sim->instructions_count], address);
+        if(next < 0) {
+            printf("Error: the word at address %i is not a legal instruction\n", address);
+            return false;
+        }
+        sim->decoded[address - sim->code_start] = &sim->instructions[sim->instructions_count++];
+        address = next;
+    }
+    for(i = 0; i < sim->instructions_count; i++) { /* link the instructions once so the handlers don't search for them while running */
+        address = sim->instructions[i].address;
+        next = i + 1 < sim->instructions_count ? sim->instructions[i+1].address : code_end;
+        sim->instructions[i].next = sim->decoded[next - sim->code_start];
+        if(is_opcode_parameter_addresing(sim->instructions[i].opcode)) {
+            address = sim->instructions[i].target - sim->code_start;
+            if(address >= 0 && address < sim->code_length)
+                sim->instructions[i].jump = sim->decoded[address];
+        }
+    }
+    return true;
+}
+
+simulator *create_simulator() {
+    simulator *sim = (simulator*) malloc_and_check(sizeof(simulator));
+    sim->instructions = NULL;
+    sim->decoded = NULL;
+    sim->instructions_count = 0;
+    sim->code_start = IC_START;
+    sim->code_length = 0;
+    sim->steps = 0;
+    sim->seconds = 0;
+    sim->status = SIMULATION_STOPPED;
+    return sim;
+}
+
+int simulator_load(simulator *sim, char *file_name) {
+    char word[WORD_BIT+2]; /* the binary representation of the current word and 1 char to find words that are too long */
+    int code_length, data_length, address, value, i, words = 0;
+    FILE *file;
+    if(sim == NULL)
+        return false;
+    free(sim->instructions);
+    free(sim->decoded);
+    sim->instructions = NULL;
+    sim->decoded = NULL;
+    for(i = 0; i < SIM_MEMORY_SIZE; i++)
+        sim->memory[i] = 0;
+    file = open_file(file_name, ".ob", "r");
+    if(file == NULL)
+        return false;
+    if(fscanf(file, "%i %i", &code_length, &data_length) != 2 || code_length < 0 || data_length < 0) {
+        printf("Error: the object file %s.ob doesn't start with the words and data count\n", file_name);
+        fclose(file);
+        return false;
+    }
+    sim->code_length = code_length;
+    while(fscanf(file, "%d %15s", &address, word) == 2) { /* the address is read as decimal because it is written with leading zeros */
+        if(strlen(word) != WORD_BIT || address < 0 || address >= SIM_MEMORY_SIZE) {
+            printf("Error: the object file %s.ob has an illegal word at address %i\n", file_name, address);
+            fclose(file);
+            return false;
+        }
+        if(words == 0)
+            sim->code_start = address;
+        for(i = 0, value = 0; i < WORD_BIT; i++) /* the binary representation uses '.' for 0 and '/' for 1 */
+            value = (value << 1) | (word[i] == '/');
+        sim->memory[address] = value;
+        words++;
+    }
+    fclose(file);
+    if(words != code_length + data_length) {
+        printf("Error: the object file %s.ob contains %i words instead of %i\n", file_name, words, code_length + data_length);
+        return false;
+    }
+    for(i = sim->code_start + code_length; i < sim->code_start + words; i++) /* data words are signed 14 bit values */
+        sim->memory[i] = sim_word_value(sim->memory[i]);
+    return sim_predecode(sim);
+}
+
+SIMULATION_STATUS simulator_run(simulator *sim, long max_steps) {
+    sim_instruction *current;
+    long steps = 0;
+    clock_t start;
+    int i;
+    for(i = 0; i < MAX_REGISTERS; i++)
+        sim->registers[i] = 0;
+    sim->zero_flag = false;
+    sim->stack_size = 0;
+    sim->status = SIMULATION_STEP_LIMIT; /* used as the running status until a handler stops the simulation */
+    current = sim->code_length > 0 ? sim->decoded[0] : NULL;
+    if(current == NULL)
+        sim->status = SIMULATION_STOPPED;
+    start = clock();
+    while(current != NULL && steps < max_steps) { /* every handler returns the next instruction to execute */
+        current = current->execute(sim, current);
+        steps++;
+    }
+    sim->seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    sim->steps = steps;
+    if(current == NULL && sim->status == SIMULATION_STEP_LIMIT) { /* the handlers set the status only on stop and faults */
+        printf("Error: simulation fault: the program ran past the end of the code\n");
+        sim->status = SIMULATION_FAULT;
+    }
+    return sim->status;
+}
+
+long simulator_get_steps(simulator *sim) {
+    return sim != NULL ? sim->steps : 0;
+}
+
+double simulator_get_seconds(simulator *sim) {
+    return sim != NULL ? sim->seconds : 0;
+}
+
+void free_simulator(simulator *sim) {
+    if(sim == NULL) return;
+    free(sim->instructions);
+    free(sim->decoded);
+    free(sim);
+}
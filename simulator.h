@@ -0,0 +1,75 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#define SIM_MEMORY_SIZE 4096 /* the number of memory words the simulator contains, operands can only hold 12 bit addresses */
+#define SIM_STACK_SIZE 256 /* the maximum number of return addresses that jsr can push before rts pops them */
+#define SIM_MAX_STEPS 100000000L /* the maximum number of instructions a single program can execute before the simulator stops it */
+
+/**
+ * An enum used for informing the reason that a simulation stopped.
+*/
+typedef enum SIMULATION_STATUS
+{
+    SIMULATION_STOPPED, /* the program reached a stop instruction */
+    SIMULATION_STEP_LIMIT, /* the program executed the maximum number of instructions allowed */
+    SIMULATION_FAULT /* the program did an illegal operation, such as jumping outside the code or using an extern label */
+} SIMULATION_STATUS;
+
+/**
+ * A data structure used for simulating the machine on an assembled program:
+ * it contains the memory, the 8 registers, the zero flag, the return address stack
+ * and the predecoded instructions of the program code.
+*/
+typedef struct simulator_t simulator;
+
+/**
+ * Creates an empty simulator without a program.
+ * @returns the newly created simulator.
+*/
+simulator *create_simulator();
+
+/**
+ * Loads the object file of a given file name into the simulator memory and
+ * decodes every instruction of the program code once into the predecoded instruction array.
+ * The words of each instruction are decoded in the same structure that the words encoders of instruction.c create them.
+ * @param sim a given simulator.
+ * @param file_name a given file name without extension.
+ * @returns true\1 if the program was loaded successfully, returns false\0 otherwise.
+*/
+int simulator_load(simulator *sim, char *file_name);
+
+/**
+ * Runs the loaded program from its first instruction until a stop instruction is executed,
+ * a fault occurs or the number of executed instructions reaches a given maximum.
+ * Each predecoded instruction points to the handler of its opcode and the handler returns the next instruction to execute.
+ * The registers operate on 14 bit words, the instructions: cmp, add, sub, not, clr, inc and dec set the zero flag that bne checks.
+ * jsr pushes the address of the next instruction to the return stack and rts pops it.
+ * When jmp, bne or jsr use parameter addressing the first parameter is copied to r6 and the second to r7 before jumping.
+ * red reads one character from the standard input and prn prints the value of its operand.
+ * @param sim a given simulator.
+ * @param max_steps the maximum number of instructions to execute.
+ * @returns the reason the simulation stopped.
+*/
+SIMULATION_STATUS simulator_run(simulator *sim, long max_steps);
+
+/**
+ * Returns the number of instructions the simulator executed in the last run.
+ * @param sim a given simulator.
+ * @returns the number of executed instructions, if sim is NULL then returns 0.
+*/
+long simulator_get_steps(simulator *sim);
+
+/**
+ * Returns the processor time in seconds that the last run took.
+ * @param sim a given simulator.
+ * @returns the run time in seconds, if sim is NULL then returns 0.
+*/
+double simulator_get_seconds(simulator *sim);
+
+/**
+ * Free the memory a given simulator contains from the system memory.
+ * @param sim a given simulator.
+*/
+void free_simulator(simulator *sim);
+
+#endif
@@ -0,0 +1,74 @@
+; file label_address_exceptions.as
+MAIN: lea NEAR, r1
+lea FAR, r2
+cmp r3, FAR
+bne MAIN(FAR,r1)
+stop
+S0: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S1: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S2: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S3: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S4: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S5: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S6: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S7: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S8: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S9: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S10: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S11: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S12: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S13: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S14: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S15: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S16: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S17: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S18: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S19: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S20: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S21: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S22: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S23: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S24: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S25: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S26: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S27: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S28: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S29: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S30: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S31: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S32: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S33: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S34: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S35: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S36: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S37: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S38: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S39: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S40: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S41: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S42: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S43: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S44: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S45: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S46: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S47: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S48: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S49: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S50: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S51: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S52: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S53: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S54: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S55: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S56: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S57: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S58: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S59: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S60: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S61: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S62: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+S63: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+NEAR: .data 1
+T0: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+T1: .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+FAR: .data 2
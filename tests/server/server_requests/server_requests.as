@@ -0,0 +1,6 @@
+; file server_requests.as
+; run "main --server < server_requests.in": the requests assemble this file, write and assemble server_source.as from the input,
+; assemble a missing file and send an unknown request, the output is server_requests.out
+MAIN: mov r1, r2
+prn #-3
+stop
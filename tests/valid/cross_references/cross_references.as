@@ -0,0 +1,13 @@
+; file cross_references.as
+.entry LOOP
+.extern W
+MAIN: mov K, r1
+LOOP: cmp K, #3
+bne END
+add W, r2
+jmp LOOP(K,W)
+prn STR
+END: stop
+STR: .string "ok"
+K: .data 4
+UNUSED: .data 1
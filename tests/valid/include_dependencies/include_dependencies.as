@@ -0,0 +1,6 @@
+; file include_dependencies.as
+.include "include_dependencies_macros.inc"
+MAIN: mov LIST, r3
+clear
+prn #7
+stop
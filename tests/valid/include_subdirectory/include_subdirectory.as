@@ -0,0 +1,6 @@
+; file include_subdirectory.as
+.include "macros/include_subdirectory_macros.inc"
+MAIN: mov LIST, r3
+clear
+prn #7
+stop
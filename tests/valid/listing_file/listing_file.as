@@ -0,0 +1,15 @@
+; file listing_file.as
+.entry MAIN
+.extern W
+mcr twice
+ inc r1
+ inc r1
+endmcr
+MAIN: mov r1, r2
+twice
+LOOP: jmp L1(#-1,r6)
+bne W(r4,r5)
+L1: prn #-5
+stop
+STR: .string "abcdef"
+LENGTH: .data 6,-9,15
@@ -0,0 +1,9 @@
+; file prelude_shadowing.as
+MAIN: mov #3, r1
+clear
+mcr clear
+ clr r1
+ clr r2
+endmcr
+clear
+finish
@@ -0,0 +1,12 @@
+; file symbols_file.as
+.entry MAIN
+.extern W
+MAIN: mov r1, LIST
+LOOP: jmp W
+EMPTY:
+prn #-5
+bne LOOP
+END: stop
+LIST: .data 6,-9,15
+STR: .string "abc"
+.entry LIST
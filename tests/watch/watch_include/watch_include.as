@@ -0,0 +1,7 @@
+; file watch_include.as
+; run "main --watch watch_include", then copy watch_include_lib.edit over watch_include_lib.inc:
+; the file is assembled again and its outputs become watch_include.am and watch_include.ob, the output is watch_include.out
+.include "watch_include_lib.inc"
+MAIN: mov VALUE, r1
+step
+stop
@@ -4,11 +4,70 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include "utils.h"
+#include "memory.h"
+
+#define W CHAR_WORD /* short names for the rows of the char classes table */
+#define S CHAR_WHITESPACE
+#define E CHAR_END
+#define C CHAR_COMMA
+#define Q CHAR_QUOTE
+#define P CHAR_PARENTHESIS
+const unsigned char char_classes[256] = {
+    E, W, W, W, W, W, W, W, W, S, E, W, W, S, W, W, /* 0x00 - 0x0F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x10 - 0x1F */
+    S, W, Q, W, W, W, W, W, P, P, W, W, C, W, W, W, /* 0x20 - 0x2F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x30 - 0x3F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x40 - 0x4F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x50 - 0x5F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x60 - 0x6F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x70 - 0x7F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x80 - 0x8F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0x90 - 0x9F */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0xA0 - 0xAF */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0xB0 - 0xBF */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0xC0 - 0xCF */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0xD0 - 0xDF */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, /* 0xE0 - 0xEF */
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W /* 0xF0 - 0xFF */
+};
+#undef W
+#undef S
+#undef E
+#undef C
+#undef Q
+#undef P
 
 struct error_location_t {
     char *file_name; /* the file name where the error occurs */
     int line; /* the line index in the file */
-    int index; /* the character index in the current line */
+    int index; /* the character index in the current line, used when the index is not tracked */
+    const int *tracked_index; /* the variable of the scan that holds the character index, read only when an error is printed, can be NULL */
+    diagnostics *diagnostics; /* the diagnostics to add the errors into, if NULL then the errors are printed */
+};
+
+struct diagnostics_t {
+    DIAGNOSTICS_FORMAT format; /* the format of the errors */
+    int max_errors; /* the maximum number of errors to keep, DIAGNOSTICS_UNLIMITED keeps every error */
+    int count; /* the number of errors inside the text */
+    output_buffer *text; /* the formatted errors one after the other */
+    size_t *ends; /* the offset of the end of every error inside the text */
+    int size; /* the number of offsets the ends array can contain */
+};
+
+struct line_reader_t {
+    block_reader read_block; /* reads the next block */
+    void *context; /* the source that read_block reads from */
+    char block[INPUT_BLOCK_SIZE]; /* the last block read from the source */
+    size_t position; /* the index of the next character to read in the block */
+    size_t length; /* the number of characters inside the block */
+};
+
+struct output_buffer_t {
+    block_writer write_block; /* writes a full block, if NULL then the buffer keeps growing in memory */
+    void *context; /* the destination that write_block writes to */
+    char *block; /* the characters that had not been written yet */
+    size_t length; /* the number of characters inside the block */
+    size_t size; /* the number of characters the block can contain */
 };
 
 OPCODE_TYPE get_opcode_type(char str[]) {
@@ -101,10 +160,12 @@ int is_opcode_group_three(OPCODE_TYPE opcode) {
 }
 
 error_location *create_empty_error_location(char *file_name) {
-    error_location *error_info = malloc_and_check(sizeof(error_location));
+    error_location *error_info = malloc_counted(sizeof(error_location), MEMORY_ERRORS);
     error_info->file_name = file_name;
     error_info->line = 0;
     error_info->index = 0;
+    error_info->tracked_index = NULL;
+    error_info->diagnostics = NULL;
     return error_info;
 }
 
@@ -113,29 +174,383 @@ void error_location_ascend_line(error_location *error) {
         error->line++;
 }
 
+int error_location_get_line(error_location *error) {
+    return error != NULL ? error->line : 0;
+}
+
+char *error_location_get_file_name(error_location *error) {
+    return error != NULL ? error->file_name : NULL;
+}
+
+void error_location_set_line(error_location *error, int line) {
+    if(error != NULL)
+        error->line = line;
+}
+
 void error_location_set_index(error_location *error, int index) {
     if(error != NULL)
         error->index = index;
 }
 
+void error_location_track_index(error_location *error, const int *index) {
+    if(error == NULL)
+        return;
+    if(error->tracked_index != NULL) /* the last index of the scan is kept for the errors after it */
+        error->index = *error->tracked_index;
+    error->tracked_index = index;
+}
+
+void error_location_set_diagnostics(error_location *error, diagnostics *diag) {
+    if(error != NULL)
+        error->diagnostics = diag;
+}
+
+diagnostics *error_location_get_diagnostics(error_location *error) {
+    return error != NULL ? error->diagnostics : NULL;
+}
+
+int error_location_limit_reached(error_location *error) {
+    return error != NULL && diagnostics_limit_reached(error->diagnostics);
+}
+
 int print_error_location(error_location *error, char *error_message, ...) {
     va_list args;
-    int count;
-    if(error != NULL)
-        printf("Error(%s:%i:%i): ", error->file_name, error->line, error->index);
-    if(error_message != NULL) { /* use the function vprintf with va_list to decode the additional variables the function received (if there are) with the error message */
-        va_start(args, error_message); /* starts the va_list with the error_message */
-        count = vprintf(error_message, args); /* get the number of characters that are printed, if an error occurs then it is a negative number */
-        va_end(args); /* closes the va_list */
-        printf("\n");
+    int count = 0, index;
+    char message[ERROR_MESSAGE_SIZE]; /* the error message after its additional variables were decoded */
+    if(error_message == NULL)
+        return count;
+    va_start(args, error_message); /* starts the va_list with the error_message */
+    count = vsprintf(message, error_message, args); /* the arguments of error messages are at most a command long */
+    va_end(args); /* closes the va_list */
+    if(error == NULL) {
+        printf("%s\n", message);
+        return count;
     }
+    index = error->tracked_index != NULL ? *error->tracked_index : error->index; /* the index is computed only for the errors */
+    if(error->diagnostics == NULL)
+        printf("Error(%s:%i:%i): %s\n", error->file_name, error->line, index, message);
+    else
+        diagnostics_add(error->diagnostics, error->file_name, error->line, index, message);
     return count;
 }
 
 void free_error_location(error_location *error) {
     if(error == NULL) return;
     free(error->file_name);
-    free(error);
+    free_counted(error);
+}
+
+diagnostics *create_diagnostics(DIAGNOSTICS_FORMAT format, int max_errors) {
+    diagnostics *diag = (diagnostics*) malloc_counted(sizeof(diagnostics), MEMORY_ERRORS);
+    diag->format = format;
+    diag->max_errors = max_errors > 0 ? max_errors : DIAGNOSTICS_UNLIMITED;
+    diag->count = 0;
+    diag->text = create_memory_output_buffer();
+    diag->size = DIAGNOSTICS_START_SIZE;
+    diag->ends = (size_t*) malloc_counted(sizeof(size_t) * diag->size, MEMORY_ERRORS);
+    return diag;
+}
+
+DIAGNOSTICS_FORMAT diagnostics_get_format(diagnostics *diag) {
+    return diag != NULL ? diag->format : DIAGNOSTICS_TEXT;
+}
+
+int diagnostics_get_max_errors(diagnostics *diag) {
+    return diag != NULL ? diag->max_errors : DIAGNOSTICS_UNLIMITED;
+}
+
+int diagnostics_get_count(diagnostics *diag) {
+    return diag != NULL ? diag->count : 0;
+}
+
+int diagnostics_limit_reached(diagnostics *diag) {
+    return diag != NULL && diag->max_errors != DIAGNOSTICS_UNLIMITED && diag->count >= diag->max_errors;
+}
+
+/**
+ * Writes a given string into a given output buffer as a JSON string, with quotes and escaped characters.
+ * @param buffer a given output buffer.
+ * @param str a given string.
+*/
+void output_buffer_put_json_string(output_buffer *buffer, char *str) {
+    char escaped[8]; /* the escape sequence of the current character */
+    output_buffer_puts(buffer, "\"");
+    for(; *str != '\0'; str++) {
+        if(*str == '\"' || *str == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = *str;
+            output_buffer_write(buffer, escaped, 2);
+        }
+        else if((unsigned char) *str < ' ' || (unsigned char) *str >= 127) { /* control and non ascii characters, such as the characters of illegal character errors */
+            sprintf(escaped, "\\u%04x", (unsigned char) *str);
+            output_buffer_puts(buffer, escaped);
+        }
+        else
+            output_buffer_write(buffer, str, 1);
+    }
+    output_buffer_puts(buffer, "\"");
+}
+
+int diagnostics_add(diagnostics *diag, char *file_name, int line, int index, char *message) {
+    char numbers[ERROR_MESSAGE_SIZE]; /* the location numbers of the error */
+    if(diag == NULL || diagnostics_limit_reached(diag))
+        return false;
+    if(diag->format == DIAGNOSTICS_TEXT) { /* the file name is written on its own because its length is not limited */
+        output_buffer_puts(diag->text, "Error(");
+        output_buffer_puts(diag->text, file_name);
+        sprintf(numbers, ":%i:%i): ", line, index);
+        output_buffer_puts(diag->text, numbers);
+        output_buffer_puts(diag->text, message);
+        output_buffer_puts(diag->text, "\n");
+    }
+    else if(diag->format == DIAGNOSTICS_JSON) { /* the columns start from 1 as the lines do */
+        output_buffer_puts(diag->text, "{\"file\":");
+        output_buffer_put_json_string(diag->text, file_name);
+        sprintf(numbers, ",\"line\":%i,\"column\":%i,\"message\":", line, index + 1);
+        output_buffer_puts(diag->text, numbers);
+        output_buffer_put_json_string(diag->text, message);
+        output_buffer_puts(diag->text, "}\n");
+    }
+    else { /* a SARIF result, the results are separated by commas when they are flushed */
+        output_buffer_puts(diag->text, "{\"level\":\"error\",\"message\":{\"text\":");
+        output_buffer_put_json_string(diag->text, message);
+        output_buffer_puts(diag->text, "},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+        output_buffer_put_json_string(diag->text, file_name);
+        sprintf(numbers, "},\"region\":{\"startLine\":%i,\"startColumn\":%i}}}]}", line, index + 1);
+        output_buffer_puts(diag->text, numbers);
+    }
+    if(diag->count >= diag->size) {
+        diag->size *= 2;
+        diag->ends = (size_t*) realloc_counted(diag->ends, sizeof(size_t) * diag->size, MEMORY_ERRORS);
+    }
+    diag->ends[diag->count++] = output_buffer_get_length(diag->text);
+    return true;
+}
+
+void diagnostics_append(diagnostics *diag, diagnostics *src) {
+    int i, count;
+    size_t start;
+    if(diag == NULL || src == NULL || src->count == 0)
+        return;
+    count = src->count;
+    if(diag->max_errors != DIAGNOSTICS_UNLIMITED && diag->count + count > diag->max_errors)
+        count = diag->max_errors > diag->count ? diag->max_errors - diag->count : 0;
+    if(count == 0)
+        return;
+    start = output_buffer_get_length(diag->text);
+    output_buffer_write(diag->text, output_buffer_get_text(src->text), src->ends[count - 1]); /* the errors are copied at once */
+    if(diag->count + count > diag->size) {
+        while(diag->count + count > diag->size)
+            diag->size *= 2;
+        diag->ends = (size_t*) realloc_counted(diag->ends, sizeof(size_t) * diag->size, MEMORY_ERRORS);
+    }
+    for(i = 0; i < count; i++)
+        diag->ends[diag->count++] = start + src->ends[i];
+}
+
+void diagnostics_flush(diagnostics *diag, FILE *file) {
+    output_buffer *log; /* the SARIF log of the errors */
+    char *text;
+    int i;
+    if(diag == NULL)
+        return;
+    text = output_buffer_get_text(diag->text);
+    if(diag->format != DIAGNOSTICS_SARIF) {
+        if(diag->count > 0)
+            fwrite(text, 1, output_buffer_get_length(diag->text), file);
+    }
+    else {
+        log = create_memory_output_buffer();
+        output_buffer_puts(log, "{\"version\":\"" SARIF_VERSION "\",\"runs\":[{\"tool\":{\"driver\":{\"name\":\"assembler\"}},\"results\":[");
+        for(i = 0; i < diag->count; i++) {
+            if(i > 0)
+                output_buffer_puts(log, ",");
+            output_buffer_write(log, &text[i > 0 ? diag->ends[i-1] : 0], diag->ends[i] - (i > 0 ? diag->ends[i-1] : 0));
+        }
+        output_buffer_puts(log, "]}]}\n");
+        fwrite(output_buffer_get_text(log), 1, output_buffer_get_length(log), file);
+        free_output_buffer(log);
+    }
+    free_output_buffer(diag->text); /* the errors were written, so the diagnostics start empty */
+    diag->text = create_memory_output_buffer();
+    diag->count = 0;
+}
+
+void free_diagnostics(diagnostics *diag) {
+    if(diag == NULL) return;
+    free_output_buffer(diag->text);
+    free_counted(diag->ends);
+    free_counted(diag);
+}
+
+/**
+ * Reads the next block of a given file, used as the block reader of file line readers.
+ * @param context a given file.
+ * @param block a given block to read into.
+ * @param size the size of the block.
+ * @returns the number of characters read, returns 0 at the end of the file.
+*/
+size_t read_file_block(void *context, char *block, size_t size) {
+    return fread(block, 1, size, (FILE*) context);
+}
+
+/**
+ * Writes a given block to a given file, used as the block writer of file output buffers.
+ * @param context a given file.
+ * @param block a given block.
+ * @param length the number of characters inside the block.
+*/
+void write_file_block(void *context, const char *block, size_t length) {
+    fwrite(block, 1, length, (FILE*) context);
+}
+
+void write_text_block(void *context, const char *block, size_t length) {
+    char **position = (char**) context;
+    memcpy(*position, block, length);
+    *position += length;
+}
+
+size_t read_text_block(void *context, char *block, size_t size) {
+    text_reader *reader = (text_reader*) context;
+    size_t count = reader->length - reader->position;
+    if(count > size)
+        count = size;
+    memcpy(block, &reader->text[reader->position], count);
+    reader->position += count;
+    return count;
+}
+
+int count_text_lines(char *text, size_t length) {
+    int lines = 0;
+    int line_length = 0;
+    size_t i;
+    for(i = 0; i < length; i++) {
+        line_length++;
+        if(text[i] == '\n' || line_length == MAX_COMMAND_LEN - 1) {
+            lines++;
+            line_length = 0;
+        }
+    }
+    if(line_length > 0)
+        lines++;
+    return lines;
+}
+
+unsigned long hash_text(unsigned long hash, char *text, size_t length) {
+    size_t i;
+    for(i = 0; i < length; i++)
+        hash = ((hash ^ (unsigned char) text[i]) * HASH_PRIME) & 0xFFFFFFFFUL;
+    return hash;
+}
+
+line_reader *create_line_reader(FILE *file) {
+    return create_block_line_reader(read_file_block, file);
+}
+
+line_reader *create_block_line_reader(block_reader read_block, void *context) {
+    line_reader *reader = (line_reader*) malloc_and_check(sizeof(line_reader));
+    reader->read_block = read_block;
+    reader->context = context;
+    reader->position = 0;
+    reader->length = 0;
+    return reader;
+}
+
+char *line_reader_gets(line_reader *reader, char *str, int size) {
+    int length = 0;
+    char c;
+    if(reader == NULL || size <= 0)
+        return NULL;
+    while(length < size - 1) {
+        if(reader->position == reader->length) { /* read the next block when every character of the current block was read */
+            reader->length = reader->read_block(reader->context, reader->block, INPUT_BLOCK_SIZE);
+            reader->position = 0;
+            if(reader->length == 0)
+                break;
+        }
+        c = reader->block[reader->position++];
+        str[length++] = c;
+        if(c == '\n')
+            break;
+    }
+    if(length == 0)
+        return NULL;
+    str[length] = '\0';
+    return str;
+}
+
+void free_line_reader(line_reader *reader) {
+    free(reader);
+}
+
+output_buffer *create_output_buffer(FILE *file) {
+    return create_block_output_buffer(write_file_block, file);
+}
+
+output_buffer *create_block_output_buffer(block_writer write_block, void *context) {
+    output_buffer *buffer = (output_buffer*) malloc_and_check(sizeof(output_buffer));
+    buffer->write_block = write_block;
+    buffer->context = context;
+    buffer->block = (char*) malloc_and_check(OUTPUT_BLOCK_SIZE);
+    buffer->length = 0;
+    buffer->size = OUTPUT_BLOCK_SIZE;
+    return buffer;
+}
+
+output_buffer *create_memory_output_buffer() {
+    return create_block_output_buffer(NULL, NULL);
+}
+
+void output_buffer_write(output_buffer *buffer, const char *str, size_t length) {
+    size_t count;
+    if(buffer->write_block == NULL && buffer->length + length > buffer->size) { /* memory buffers are doubled instead of written */
+        while(buffer->length + length > buffer->size)
+            buffer->size *= 2;
+        buffer->block = (char*) realloc_and_check(buffer->block, buffer->size);
+    }
+    while(length > 0) {
+        if(buffer->length == buffer->size) /* write the block when it is full */
+            output_buffer_flush(buffer);
+        count = buffer->size - buffer->length;
+        if(count > length)
+            count = length;
+        memcpy(&buffer->block[buffer->length], str, count);
+        buffer->length += count;
+        str += count;
+        length -= count;
+    }
+}
+
+void output_buffer_puts(output_buffer *buffer, const char *str) {
+    output_buffer_write(buffer, str, strlen(str));
+}
+
+char *output_buffer_get_text(output_buffer *buffer) {
+    return buffer != NULL ? buffer->block : NULL;
+}
+
+size_t output_buffer_get_length(output_buffer *buffer) {
+    return buffer != NULL ? buffer->length : 0;
+}
+
+void output_buffer_clear(output_buffer *buffer) {
+    if(buffer != NULL)
+        buffer->length = 0;
+}
+
+void output_buffer_flush(output_buffer *buffer) {
+    if(buffer->write_block == NULL) /* memory buffers keep their characters */
+        return;
+    if(buffer->length > 0)
+        buffer->write_block(buffer->context, buffer->block, buffer->length);
+    buffer->length = 0;
+}
+
+void free_output_buffer(output_buffer *buffer) {
+    if(buffer == NULL) return;
+    output_buffer_flush(buffer);
+    free(buffer->block);
+    free(buffer);
 }
 
 int is_legal_register(char str[]) {
@@ -147,11 +562,11 @@ int is_legal_register(char str[]) {
 }
 
 int is_whitespace(char c) {
-    return c == ' ' || c == '\t' || c == '\r';
+    return CHAR_CLASS_OF(c) == CHAR_WHITESPACE;
 }
 
 int is_end_null(char c) {
-    return c == '\n' || c == '\0'; 
+    return CHAR_CLASS_OF(c) == CHAR_END; 
 }
 
 int is_integer(char str[]) {
@@ -167,6 +582,11 @@ int is_integer(char str[]) {
     return check;
 }
 
+int is_integer_in_range(char str[], long min, long max) {
+    long value = strtol(str, NULL, 10); /* an integer that is too long is converted to LONG_MAX or LONG_MIN */
+    return value >= min && value <= max;
+}
+
 char *get_file_full_name(char *file_name, char *new_extension) {
     char *file_full_name;
     if(file_name == NULL || new_extension == NULL)
@@ -196,6 +616,57 @@ FILE *open_file(char *file_name, char *new_extension, char *file_open_type) {
     return file;
 }
 
+int is_file_text(char *file_name, char *new_extension, char *text, size_t length) {
+    char block[INPUT_BLOCK_SIZE]; /* the file is compared in blocks */
+    size_t position = 0, count;
+    char *file_full_name = get_file_full_name(file_name, new_extension);
+    FILE *file = file_full_name != NULL ? fopen(file_full_name, "r") : NULL; /* a missing file is not an error, it is only different */
+    int same = file != NULL;
+    free(file_full_name);
+    while(same != false && (count = fread(block, 1, INPUT_BLOCK_SIZE, file)) > 0) {
+        same = position + count <= length && memcmp(block, &text[position], count) == 0;
+        position += count;
+    }
+    if(file != NULL)
+        fclose(file);
+    return same != false && position == length;
+}
+
+char *read_text_file(char *file_name, char *new_extension, size_t *length) {
+    FILE *file = open_file(file_name, new_extension, "r");
+    char *text;
+    if(file == NULL)
+        return NULL;
+    text = read_text_stream(file, length);
+    fclose(file);
+    return text;
+}
+
+char *read_text_stream(FILE *file, size_t *length) {
+    size_t size = INPUT_BLOCK_SIZE, count;
+    char *text = (char*) malloc_and_check(size);
+    *length = 0;
+    while((count = fread(&text[*length], 1, size - *length, file)) > 0) {
+        *length += count;
+        if(*length == size) {
+            size *= 2;
+            text = (char*) realloc_and_check(text, size);
+        }
+    }
+    return text;
+}
+
+int write_text_file(char *file_name, char *new_extension, char *text, size_t length, int only_changed) {
+    FILE *file;
+    if(only_changed != false && is_file_text(file_name, new_extension, text, length) != false)
+        return true;
+    file = open_file(file_name, new_extension, "w");
+    if(file == NULL)
+        return false;
+    fwrite(text, 1, length, file);
+    fclose(file);
+    return true;
+}
 
 char *empty_binary_dot() {
     int i;
@@ -215,6 +686,15 @@ void *malloc_and_check(size_t size) {
     return ptr;
 }
 
+void *realloc_and_check(void *ptr, size_t size) {
+    void *new_ptr = realloc(ptr, size);
+    if(new_ptr == NULL) { /* if realloc failed then exit the program */
+        printf("Error: realloc out of space, could not allocate new memory\n");
+        exit(0);
+    }
+    return new_ptr;
+}
+
 char *strdup(const char *src) {
     char *dst = malloc_and_check(strlen(src) + 1);  /* the size of the original string and 1 char for '\0' at the end */
     strcpy(dst, src);
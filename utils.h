@@ -4,6 +4,15 @@
 #define MAX_REGISTERS 8 /* the maximum register a machine contains, the names that they can be start from r0 and end with r7 */
 #define MAX_COMMAND_LEN 80 /* the maximum command length is 80 */
 #define WORD_BIT 14 /* the number of bits a word contains */
+#define INPUT_BLOCK_SIZE 4096 /* the number of bytes a line reader reads from a file at once */
+#define OUTPUT_BLOCK_SIZE 4096 /* the number of bytes an output buffer holds before writing them to its file */
+#define ERROR_MESSAGE_SIZE 512 /* the maximum length of an error message that is written into a buffer */
+#define DIAGNOSTICS_UNLIMITED 0 /* the maximum number of errors of diagnostics that keep every error */
+#define DIAGNOSTICS_START_SIZE 64 /* the first number of errors a diagnostics can contain, it is doubled every time it is full */
+#define SARIF_VERSION "2.1.0" /* the version of the SARIF format that the diagnostics are written with */
+#define HASH_START 2166136261UL /* the first value of the FNV-1a hash of a text */
+#define HASH_PRIME 16777619UL /* the number the FNV-1a hash is multiplied by after every character */
+#define CHAR_CLASS_OF(c) ((CHAR_CLASS) char_classes[(unsigned char) (c)]) /* the class of a character, found with one lookup */
 #define false 0
 #define true 1
 
@@ -31,12 +40,78 @@ typedef enum OPCODE_TYPE
     OPCODE_UNKOWN /* used when the opcode is not legal\unkown or initiation */
 } OPCODE_TYPE;
 
+/**
+ * An enum used for determining the format that the errors of a file are written with.
+*/
+typedef enum DIAGNOSTICS_FORMAT
+{
+    DIAGNOSTICS_TEXT, /* every error is a line: Error(file:line:index): message */
+    DIAGNOSTICS_JSON, /* every error is a line with a JSON object that contains the file, line, column and message */
+    DIAGNOSTICS_SARIF /* the errors of every file are a single line with a SARIF log */
+} DIAGNOSTICS_FORMAT;
+
+/**
+ * An enum used for determining the class of a character for the scans: 
+ * the characters of the other classes end a word, and the scans check them one by one.
+*/
+typedef enum CHAR_CLASS
+{
+    CHAR_WORD, /* a character inside an argument, it has no checks of its own */
+    CHAR_WHITESPACE, /* ' ', '\t' and '\r' */
+    CHAR_END, /* '\n' and '\0', the end of the line */
+    CHAR_COMMA, /* ',' */
+    CHAR_QUOTE, /* '"', starts and ends a string */
+    CHAR_PARENTHESIS /* '(' and ')', the brackets of parameter addressing */
+} CHAR_CLASS;
+
+extern const unsigned char char_classes[256]; /* the class of every character, indexed by the character as an unsigned char */
+
+/**
+ * A data structure used for keeping the errors of a file in memory in a given format, 
+ * so they are written at once and the errors of files that run at the same time are not mixed. 
+ * It can stop accepting errors after a given number of errors.
+*/
+typedef struct diagnostics_t diagnostics;
+
 /**
  * A data structure that contains inforamtion about the location that an error occurred on, such as: 
  * the file name, the line where the error occurred and the index on the line of the start of the error.
 */
 typedef struct error_location_t error_location;
 
+/**
+ * A data structure used for reading lines from a file or another source in blocks of INPUT_BLOCK_SIZE bytes.
+*/
+typedef struct line_reader_t line_reader;
+
+/**
+ * A data structure used for writing text to a file or another destination in blocks of OUTPUT_BLOCK_SIZE bytes,
+ * so the memory it uses is bounded no matter how much text is written. 
+ * A memory output buffer has no destination and keeps all the text it receives.
+*/
+typedef struct output_buffer_t output_buffer;
+
+/**
+ * A data structure used for reading a text in memory as the source of a line reader.
+*/
+typedef struct text_reader
+{
+    char *text; /* the text to read */
+    size_t length; /* the number of characters inside the text */
+    size_t position; /* the index of the next character to read */
+} text_reader;
+
+/**
+ * A function that reads the next block of a source into a given block with a given size, 
+ * and returns the number of characters read or 0 at the end of the source.
+*/
+typedef size_t (*block_reader)(void *context, char *block, size_t size);
+
+/**
+ * A function that writes a given block with a given length to a destination.
+*/
+typedef void (*block_writer)(void *context, const char *block, size_t length);
+
 /**
  * Returns the opcode type to identify a given string.
  * @param str a given string.
@@ -102,6 +177,27 @@ error_location *create_empty_error_location(char *file_name);
 */
 void error_location_ascend_line(error_location *error);
 
+/**
+ * Returns the error location line value.
+ * @param error a given error location.
+ * @returns the line value, if the error location is NULL then returns 0.
+*/
+int error_location_get_line(error_location *error);
+
+/**
+ * Returns the error location file name.
+ * @param error a given error location.
+ * @returns the file name, if the error location is NULL then returns NULL.
+*/
+char *error_location_get_file_name(error_location *error);
+
+/**
+ * Sets the error location line value to a given integer.
+ * @param error a given error location.
+ * @param line a given line.
+*/
+void error_location_set_line(error_location *error, int line);
+
 /**
  * Sets the error location index value to a given integer.
  * @param error a given error location.
@@ -109,9 +205,40 @@ void error_location_ascend_line(error_location *error);
 */
 void error_location_set_index(error_location *error, int index);
 
+/**
+ * Sets a given variable of a scan as the character index of a given error location: the variable is read only when an error is printed, 
+ * so the scan does not update the error location for every character. When the tracking stops the last value of the variable is kept as the index.
+ * The tracking must stop before the variable goes out of scope.
+ * @param error a given error location.
+ * @param index the variable that holds the index, NULL to stop the tracking.
+*/
+void error_location_track_index(error_location *error, const int *index);
+
+/**
+ * Sets the diagnostics that a given error location adds its errors into instead of printing them.
+ * @param error a given error location.
+ * @param diag a given diagnostics, if NULL then the errors are printed.
+*/
+void error_location_set_diagnostics(error_location *error, diagnostics *diag);
+
+/**
+ * Returns the diagnostics that a given error location adds its errors into.
+ * @param error a given error location.
+ * @returns the diagnostics, returns NULL if the errors are printed or the error location is NULL.
+*/
+diagnostics *error_location_get_diagnostics(error_location *error);
+
+/**
+ * Checks if the diagnostics of a given error location reached its maximum number of errors, then the scan of the file should stop.
+ * @param error a given error location.
+ * @returns true\1 if the maximum number of errors was reached, returns false\0 otherwise.
+*/
+int error_location_limit_reached(error_location *error);
+
 /**
  * Prints an error inforamtion (where it occurred) with a given error location and print the error message similar to printf: 
- * the function can have a diffresnt number of additional variables to add t othe string message after each '%' character.
+ * the function can have a diffresnt number of additional variables to add t othe string message after each '%' character. 
+ * If the error location has diagnostics then the error is added to them instead of being printed.
  * @param error the current error location.
  * @param error_message a given error message.
  * @returns the total number of characters written excluding the error location, if an error occurs then a negative number is returned.
@@ -124,6 +251,213 @@ int print_error_location(error_location *error, char *error_message, ...);
 */
 void free_error_location(error_location *error);
 
+/**
+ * Creates empty diagnostics with a given format and maximum number of errors.
+ * @param format the format to write the errors with.
+ * @param max_errors the maximum number of errors to keep, DIAGNOSTICS_UNLIMITED keeps every error.
+ * @returns the newly created diagnostics.
+*/
+diagnostics *create_diagnostics(DIAGNOSTICS_FORMAT format, int max_errors);
+
+/**
+ * Returns the format of given diagnostics.
+ * @param diag given diagnostics.
+ * @returns the format, if diag is NULL then returns DIAGNOSTICS_TEXT.
+*/
+DIAGNOSTICS_FORMAT diagnostics_get_format(diagnostics *diag);
+
+/**
+ * Returns the maximum number of errors of given diagnostics.
+ * @param diag given diagnostics.
+ * @returns the maximum number of errors, if diag is NULL then returns DIAGNOSTICS_UNLIMITED.
+*/
+int diagnostics_get_max_errors(diagnostics *diag);
+
+/**
+ * Returns the number of errors given diagnostics contain.
+ * @param diag given diagnostics.
+ * @returns the number of errors, if diag is NULL then returns 0.
+*/
+int diagnostics_get_count(diagnostics *diag);
+
+/**
+ * Checks if given diagnostics reached their maximum number of errors.
+ * @param diag given diagnostics.
+ * @returns true\1 if the maximum number of errors was reached, returns false\0 otherwise.
+*/
+int diagnostics_limit_reached(diagnostics *diag);
+
+/**
+ * Formats an error with its location and adds it to given diagnostics.
+ * @param diag given diagnostics.
+ * @param file_name the file name where the error occurs.
+ * @param line the line of the error.
+ * @param index the character index of the error in the line.
+ * @param message the error message.
+ * @returns true\1 if the error was added, returns false\0 if the maximum number of errors was already reached.
+*/
+int diagnostics_add(diagnostics *diag, char *file_name, int line, int index, char *message);
+
+/**
+ * Adds the errors of given source diagnostics to the end of given diagnostics, until the maximum number of errors is reached. 
+ * Both diagnostics must have the same format.
+ * @param diag given diagnostics.
+ * @param src given source diagnostics.
+*/
+void diagnostics_append(diagnostics *diag, diagnostics *src);
+
+/**
+ * Writes the errors of given diagnostics to a given file with a single write and removes them from the diagnostics. 
+ * Text and JSON errors are written only if there are errors, a SARIF log is written even without errors.
+ * @param diag given diagnostics.
+ * @param file a given file.
+*/
+void diagnostics_flush(diagnostics *diag, FILE *file);
+
+/**
+ * Free the memory given diagnostics contain from the system memory.
+ * @param diag given diagnostics.
+*/
+void free_diagnostics(diagnostics *diag);
+
+/**
+ * Writes a given block to a given text position and moves the position after the block, used as the block writer of output buffers that write into a text in memory.
+ * The text must have the room for every block written.
+ * @param context a given pointer to the text position.
+ * @param block a given block.
+ * @param length the number of characters inside the block.
+*/
+void write_text_block(void *context, const char *block, size_t length);
+
+/**
+ * Reads the next characters of a given text reader into a given block, used as the block reader of line readers that read a text in memory.
+ * @param context a given text reader.
+ * @param block a given block to read into.
+ * @param size the size of the block.
+ * @returns the number of characters read, returns 0 at the end of the text.
+*/
+size_t read_text_block(void *context, char *block, size_t size);
+
+/**
+ * Counts the number of lines a line reader reads from a given text: 
+ * a line ends after a new line character or after MAX_COMMAND_LEN - 1 characters, the same way line_reader_gets splits them.
+ * @param text a given text.
+ * @param length the number of characters inside the text.
+ * @returns the number of lines in the text.
+*/
+int count_text_lines(char *text, size_t length);
+
+/**
+ * Computes the FNV-1a hash of a given text, continuing from a given hash so a text can be hashed in parts.
+ * @param hash the hash of the text before the given part, HASH_START for a new text.
+ * @param text a given text.
+ * @param length the number of characters inside the text.
+ * @returns the hash of the text including the given part.
+*/
+unsigned long hash_text(unsigned long hash, char *text, size_t length);
+
+/**
+ * Creates a line reader that reads from a given file.
+ * @param file a given file opened for reading.
+ * @returns the newly created line reader.
+*/
+line_reader *create_line_reader(FILE *file);
+
+/**
+ * Creates a line reader that reads the blocks of its source with a given block reader.
+ * @param read_block a given block reader.
+ * @param context the source that the block reader reads from.
+ * @returns the newly created line reader.
+*/
+line_reader *create_block_line_reader(block_reader read_block, void *context);
+
+/**
+ * Reads the next line of a given line reader into a given string, the same way fgets reads from a file: 
+ * reads until a new line character (that is added to the string) or until size - 1 characters were read.
+ * @param reader a given line reader.
+ * @param str a given string to store the line.
+ * @param size the size of the string.
+ * @returns str if characters were read, returns NULL at the end of the file.
+*/
+char *line_reader_gets(line_reader *reader, char *str, int size);
+
+/**
+ * Free the memory a given line reader contains from the system memory, the file is not closed.
+ * @param reader a given line reader.
+*/
+void free_line_reader(line_reader *reader);
+
+/**
+ * Creates an empty output buffer that writes to a given file.
+ * @param file a given file opened for writing.
+ * @returns the newly created output buffer.
+*/
+output_buffer *create_output_buffer(FILE *file);
+
+/**
+ * Creates an empty output buffer that writes every full block with a given block writer.
+ * @param write_block a given block writer, if NULL then the buffer keeps growing in memory.
+ * @param context the destination that the block writer writes to.
+ * @returns the newly created output buffer.
+*/
+output_buffer *create_block_output_buffer(block_writer write_block, void *context);
+
+/**
+ * Creates an empty output buffer that keeps every character it receives in memory.
+ * @returns the newly created output buffer.
+*/
+output_buffer *create_memory_output_buffer();
+
+/**
+ * Adds a given number of characters from a given string to an output buffer, 
+ * every time the buffer is full its block is written to the file.
+ * @param buffer a given output buffer.
+ * @param str a given string.
+ * @param length the number of characters to add.
+*/
+void output_buffer_write(output_buffer *buffer, const char *str, size_t length);
+
+/**
+ * Adds a given string to an output buffer.
+ * @param buffer a given output buffer.
+ * @param str a given string.
+*/
+void output_buffer_puts(output_buffer *buffer, const char *str);
+
+/**
+ * Returns the characters that a given output buffer holds and had not been written yet, 
+ * for memory output buffers those are all the characters it received.
+ * @param buffer a given output buffer.
+ * @returns the characters of the buffer (not ending with '\0'), if the buffer is NULL then returns NULL.
+*/
+char *output_buffer_get_text(output_buffer *buffer);
+
+/**
+ * Returns the number of characters that a given output buffer holds and had not been written yet.
+ * @param buffer a given output buffer.
+ * @returns the number of characters of the buffer, if the buffer is NULL then returns 0.
+*/
+size_t output_buffer_get_length(output_buffer *buffer);
+
+/**
+ * Removes the characters that a given output buffer holds without writing them, used for reusing memory buffers.
+ * @param buffer a given output buffer.
+*/
+void output_buffer_clear(output_buffer *buffer);
+
+/**
+ * Writes the characters inside a given output buffer to its file, memory output buffers are not changed.
+ * @param buffer a given output buffer.
+*/
+void output_buffer_flush(output_buffer *buffer);
+
+/**
+ * Writes the characters left inside a given output buffer to its file and 
+ * free the memory the buffer contains from the system memory, the file is not closed.
+ * @param buffer a given output buffer.
+*/
+void free_output_buffer(output_buffer *buffer);
+
 /**
  * Checks if a given string is a legal register name and if so returns the register number in ascii.
  * @param str a given string
@@ -153,6 +487,15 @@ int is_end_null(char c);
 */
 int is_integer(char str[]);
 
+/**
+ * Checks if a given valid integer string is between 2 given bounds, an integer that is too long for a long is out of the bounds.
+ * @param str a given string of a valid integer, as is_integer checks it.
+ * @param min the smallest value of the range.
+ * @param max the biggest value of the range.
+ * @returns true if the integer is between min and max, returns false otherwise
+*/
+int is_integer_in_range(char str[], long min, long max);
+
 /**
  * Create the full name of a file string containing a given file name and a given file extension.
  * @param file_name a given file name without extensions.
@@ -170,6 +513,45 @@ char *get_file_full_name(char *file_name, char *new_extension);
 */
 FILE *open_file(char *file_name, char *new_extension, char *file_open_type);
 
+/**
+ * Reads the whole file of a given file name and extension into memory.
+ * @param file_name a given file name
+ * @param new_extension a given file extension
+ * @param length a pointer to store the number of characters read
+ * @returns the text of the file, returns NULL if the file could not be opened.
+*/
+char *read_text_file(char *file_name, char *new_extension, size_t *length);
+
+/**
+ * Reads the rest of a given opened file into memory, the file is not closed.
+ * @param file a given opened file
+ * @param length a pointer to store the number of characters read
+ * @returns the text of the file.
+*/
+char *read_text_stream(FILE *file, size_t *length);
+
+/**
+ * Checks if the file of a given file name and extension contains exactly a given text.
+ * @param file_name a given file name
+ * @param new_extension a given file extension
+ * @param text a given text
+ * @param length the number of characters inside the text
+ * @returns true if the file exists and contains the text, returns false otherwise.
+*/
+int is_file_text(char *file_name, char *new_extension, char *text, size_t length);
+
+/**
+ * Writes a given text into the file of a given file name and extension with a single write. 
+ * If only_changed is true and the file already contains exactly the text then it is not written again, so its modification time is kept.
+ * @param file_name a given file name
+ * @param new_extension a given file extension
+ * @param text a given text
+ * @param length the number of characters inside the text
+ * @param only_changed true\1 if the file is written only when its text changed
+ * @returns true if the file contains the text, returns false if the file can't be opened.
+*/
+int write_text_file(char *file_name, char *new_extension, char *text, size_t length, int only_changed);
+
 /**
  * Create an empty binary string containing only dots.
  * @returns the created string, if the memory wasn't allocated then returns NULL
@@ -183,6 +565,15 @@ char *empty_binary_dot();
 */
 void *malloc_and_check(size_t size);
 
+/**
+ * Changes the size of the memory a given void pointer points to, to a given size, with realloc. 
+ * If new memory could not be allocated then exit the program.
+ * @param ptr a given void pointer, can be NULL.
+ * @param size the new size of the memory.
+ * @returns the pointer to the memory with the new size.
+*/
+void *realloc_and_check(void *ptr, size_t size);
+
 /**
  * Creates a copy of a given string content. 
  * Copies the given string to the newly created string and return the string copy of the original string.
@@ -0,0 +1,220 @@
+#define _POSIX_C_SOURCE 200809L /* stat with nanosecond modification times and nanosleep */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "watch.h"
+#include "incremental.h"
+#include "utils.h"
+
+/**
+ * A data structure used for the state of a text file from its last check: a .as file, a file it included or the prelude.
+*/
+typedef struct watched_text
+{
+    char *name; /* the full name of the file */
+    struct timespec modified; /* the modification time of the file */
+    off_t size; /* the size of the file */
+    unsigned long hash; /* the hash of the file text in the last check */
+    int hashed; /* true\1 after the file was hashed once */
+    int exists; /* true\1 if the file existed in the last check */
+} watched_text;
+
+/**
+ * A data structure used for the state of a watched file from its last check.
+*/
+typedef struct watched_file
+{
+    char *name; /* the file name without extension */
+    watched_text source; /* the .as file */
+    watched_text *dependencies; /* the files that the .as file included in its last assembly */
+    int dependencies_count; /* the number of files inside the dependencies array */
+    int dependencies_size; /* the number of files the dependencies array can contain */
+    assembly_model *model; /* the segments of the .am file from the last assembly, so only the changed lines are scanned again */
+} watched_file;
+
+/**
+ * Computes the FNV-1a hash of the text of a given file.
+ * @param file_name the full name of the file.
+ * @param hash a given pointer to set to the hash.
+ * @returns true\1 if the file was read, returns false\0 otherwise.
+*/
+int hash_file(char *file_name, unsigned long *hash) {
+    char block[INPUT_BLOCK_SIZE]; /* the file is read in blocks */
+    size_t count;
+    FILE *file = fopen(file_name, "r");
+    if(file == NULL)
+        return false;
+    *hash = HASH_START;
+    while((count = fread(block, 1, INPUT_BLOCK_SIZE, file)) > 0)
+        *hash = hash_text(*hash, block, count);
+    fclose(file);
+    return true;
+}
+
+/**
+ * Sets a given watched text to a file of a given name that was not checked yet.
+ * @param text a given watched text.
+ * @param name the full name of the file, the watched text owns it.
+*/
+void init_watched_text(watched_text *text, char *name) {
+    text->name = name;
+    text->size = 0;
+    text->hash = 0;
+    text->hashed = false;
+    text->exists = true; /* a file that is missing from the start is reported */
+}
+
+/**
+ * Checks if the text of a given watched text changed since its last check, the file is hashed only when its size or modification time changed.
+ * @param text a given watched text.
+ * @returns true\1 if the file was created, removed or its text changed since the last check, returns false\0 otherwise.
+*/
+int watch_text_changed(watched_text *text) {
+    struct stat info;
+    unsigned long hash;
+    if(stat(text->name, &info) != 0) {
+        if(text->exists == false)
+            return false;
+        text->exists = false;
+        text->hashed = false; /* the file is new when it is created again */
+        return true;
+    }
+    if(text->exists != false && text->hashed != false && info.st_size == text->size
+        && info.st_mtim.tv_sec == text->modified.tv_sec && info.st_mtim.tv_nsec == text->modified.tv_nsec)
+        return false;
+    text->exists = true;
+    text->size = info.st_size;
+    text->modified = info.st_mtim;
+    if(hash_file(text->name, &hash) == false || (text->hashed != false && hash == text->hash)) /* a file that was saved without changes did not change */
+        return false;
+    text->hash = hash;
+    text->hashed = true;
+    return true;
+}
+
+/**
+ * Sets the dependencies of a given watched file to the files that the last file expanded with a given include cache included. 
+ * A file that was already a dependency keeps its state, a new dependency is checked now so its next change is found.
+ * @param file a given watched file.
+ * @param cache the include cache that the file was expanded with.
+*/
+void watch_set_dependencies(watched_file *file, include_cache *cache) {
+    size_t length, start, end;
+    char *names = include_cache_get_dependencies(cache, &length);
+    watched_text *old = file->dependencies;
+    int old_count = file->dependencies_count, i;
+    file->dependencies_size = WATCH_DEPENDENCIES_START_SIZE;
+    file->dependencies = (watched_text*) malloc_and_check(sizeof(watched_text) * file->dependencies_size);
+    file->dependencies_count = 0;
+    for(start = 0; start < length; start = end) {
+        for(start++, end = start; end < length && names[end] != ' '; end++) /* every name is after a space */
+            ;
+        for(i = 0; i < file->dependencies_count && (strlen(file->dependencies[i].name) != end - start
+            || strncmp(file->dependencies[i].name, &names[start], end - start) != 0); i++) /* a file that was included twice is watched once */
+            ;
+        if(i < file->dependencies_count)
+            continue;
+        if(file->dependencies_count == file->dependencies_size) {
+            file->dependencies_size *= 2;
+            file->dependencies = (watched_text*) realloc_and_check(file->dependencies, sizeof(watched_text) * file->dependencies_size);
+        }
+        for(i = 0; i < old_count && (old[i].name == NULL || strlen(old[i].name) != end - start || strncmp(old[i].name, &names[start], end - start) != 0); i++)
+            ;
+        if(i < old_count) { /* the old state is moved */
+            file->dependencies[file->dependencies_count++] = old[i];
+            old[i].name = NULL;
+            continue;
+        }
+        init_watched_text(&file->dependencies[file->dependencies_count], (char*) malloc_and_check(end - start + 1));
+        memcpy(file->dependencies[file->dependencies_count].name, &names[start], end - start);
+        file->dependencies[file->dependencies_count].name[end - start] = '\0';
+        watch_text_changed(&file->dependencies[file->dependencies_count++]);
+    }
+    for(i = 0; i < old_count; i++)
+        free(old[i].name);
+    free(old);
+}
+
+/**
+ * Checks a given watched file and assembles it if the text of its .as file or of a file it included changed since it was last assembled.
+ * @param machine the machine that assembles the file.
+ * @param file a given watched file.
+ * @param force true\1 to assemble the file even if its texts did not change, false\0 otherwise.
+ * @returns true\1 if the file was assembled, returns false\0 otherwise.
+*/
+int watch_check_file(machine *machine, watched_file *file, int force) {
+    struct stat info;
+    int assembled, changed, i;
+    if(stat(file->source.name, &info) != 0) { /* a missing file is reported once and assembled when it is created */
+        if(file->source.exists != false) {
+            printf("Error: The file %s can't be opened\n", file->source.name);
+            fflush(stdout);
+        }
+        file->source.exists = false;
+        return false;
+    }
+    changed = watch_text_changed(&file->source);
+    for(i = 0; i < file->dependencies_count; i++) /* every dependency is checked so its state is updated */
+        if(watch_text_changed(&file->dependencies[i]) != false)
+            changed = true;
+    if(changed == false && force == false)
+        return false;
+    reset_machine(machine);
+    assembled = incremental_assembler(machine, file->model, file->name);
+    watch_set_dependencies(file, machine_get_include_cache(machine));
+    diagnostics_flush(machine_get_diagnostics(machine), stdout);
+    printf("status %s %s\n", file->name, assembled != false ? "assembled" : "failed");
+    fflush(stdout);
+    return true;
+}
+
+/**
+ * Loads the prelude again after its text changed. The files of the include cache of a given machine were expanded with the old prelude, 
+ * so they are expanded again by their next includes.
+ * @param machine the machine that uses the prelude.
+ * @param prelude a pointer to the prelude, set to the new prelude.
+ * @param prelude_name the name of the prelude file.
+ * @returns true\1 if the new prelude was loaded, returns false\0 if it has errors and the old prelude is kept.
+*/
+int watch_reload_prelude(machine *machine, macro_table **prelude, char *prelude_name) {
+    macro_table *loaded = load_macro_prelude(prelude_name, machine_get_diagnostics(machine));
+    diagnostics_flush(machine_get_diagnostics(machine), stdout);
+    fflush(stdout);
+    if(loaded == NULL)
+        return false;
+    include_cache_clear(machine_get_include_cache(machine));
+    machine_set_prelude(machine, loaded);
+    free_macro_table(*prelude);
+    *prelude = loaded;
+    return true;
+}
+
+void run_watch(machine *machine, macro_table **prelude, char *prelude_name, char **files, int count) {
+    watched_file *watched = (watched_file*) malloc_and_check(sizeof(watched_file) * (count > 0 ? count : 1));
+    watched_text prelude_text; /* the prelude file, every file is assembled again when it changes */
+    struct timespec interval;
+    int i, force;
+    interval.tv_sec = WATCH_INTERVAL_MS / 1000;
+    interval.tv_nsec = (WATCH_INTERVAL_MS % 1000) * 1000000L;
+    for(i = 0; i < count; i++) {
+        watched[i].name = files[i];
+        init_watched_text(&watched[i].source, get_file_full_name(files[i], ".as"));
+        watched[i].dependencies = NULL;
+        watched[i].dependencies_count = 0;
+        watched[i].dependencies_size = 0;
+        watched[i].model = create_assembly_model();
+    }
+    if(prelude_name != NULL) { /* the prelude was loaded before the first check */
+        init_watched_text(&prelude_text, prelude_name);
+        watch_text_changed(&prelude_text);
+    }
+    machine_set_keep_unchanged_outputs(machine, true);
+    while(true) {
+        force = prelude_name != NULL && watch_text_changed(&prelude_text) != false && watch_reload_prelude(machine, prelude, prelude_name) != false;
+        for(i = 0; i < count; i++)
+            watch_check_file(machine, &watched[i], force);
+        nanosleep(&interval, NULL);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "assembler.h"
+
+#define WATCH_INTERVAL_MS 5 /* the number of milliseconds between 2 checks of the watched files */
+#define WATCH_DEPENDENCIES_START_SIZE 4 /* the first number of included files a watched file can keep, it is doubled every time the array is full */
+
+/**
+ * Assembles given files and then keeps watching their .as files, the files they included in their last assembly and the prelude until the program is stopped.
+ * Every file keeps the modification time, size and text hash of its .as file and of every file it included from the last check,
+ * so a file is assembled again only when one of their texts changed, and the other files don't run any step. 
+ * When the text of the prelude changes it is loaded again and every file is assembled again, a prelude with errors is not used.
+ * Every file is assembled with incremental_assembler and keeps its assembly model, so only the lines that changed are scanned again by the first scan, 
+ * therefore the options --jobs and --pipeline are not used. The machine writes only the output files that their text changed.
+ * For every assembled file its errors are written in the format of the machine diagnostics and then the line "status FILE assembled" or "status FILE failed".
+ * @param machine the machine that assembles every file, the options were applied to it.
+ * @param prelude a pointer to the prelude of the machine, set to the new prelude when it is loaded again, can point to NULL.
+ * @param prelude_name the name of the prelude file, NULL if there is no prelude.
+ * @param files the file names without extension.
+ * @param count the number of files.
+*/
+void run_watch(machine *machine, macro_table **prelude, char *prelude_name, char **files, int count);
+
+#endif